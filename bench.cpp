@@ -0,0 +1,734 @@
+//============================================================================
+// Name         : bench.cpp
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Micro-benchmarks for the catalog internals
+//                usage: ./bench <name> [size]
+//============================================================================
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include "csv.h"
+#include "journal.h"
+#include "myvector.h"
+#include "smallvector.h"
+#include "pool.h"
+#include "book.h"
+#include "tree.h"
+#include "flattree.h"
+#include "textindex.h"
+#include <fstream>
+#include <unordered_map>
+#include <sys/wait.h>
+#include <unistd.h>
+using namespace std;
+
+// Seconds elapsed since a given start time
+static double secondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Build CSV text shaped like bookslist_long.csv, about the given number of bytes
+static string makeBookCsv(size_t bytes)
+{
+    static const char* titles[] = { "The Art of Computer Programming", "Operating System Concepts", "\"Structure and Interpretation, 2nd Edition\"", "Algebra", "The Lord of the Rings" };
+    static const char* authors[] = { "Donald Knuth", "\"Abraham Silberschatz, Peter Galvin\"", "Michael Artin", "J. R. R. Tolkien" };
+    static const char* categories[] = { "Computer Science/Operating Systems", "Mathematics/Algebra", "Fiction/Fantasy", "Computer Science/AI/ML" };
+
+    string csv = "Title,Author,ISBN,Publication Year,Category,Total Copies,Available Copies\n";
+    csv.reserve(bytes + 256);
+    srand(42);
+    for (int row = 0; csv.size() < bytes; ++row)
+    {
+        csv += titles[rand() % 5];
+        csv += ' ';
+        csv += to_string(row);
+        csv += ',';
+        csv += authors[rand() % 4];
+        csv += ",978" + to_string(1000000000 + rand() % 900000000) + ',' + to_string(1950 + rand() % 70) + ',';
+        csv += categories[rand() % 4];
+        csv += ',' + to_string(1 + rand() % 5) + ',' + to_string(rand() % 2) + '\n';
+    }
+    return csv;
+}
+
+// Benchmark the CSV tokenizers: the per-character line splitter against the structural indexers
+static void benchCsv(int megabytes)
+{
+    string csv = makeBookCsv((size_t)megabytes << 20);
+    const char* begin = csv.data();
+    const char* end = begin + csv.size();
+    const size_t chunk = 4 << 20; // Same slice size as the importer
+    cout << "csv: " << megabytes << " MB of book records" << endl;
+
+    // Baseline: find each line, then split it one character at a time
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    long long fields = 0;
+    FieldView row[CSV_MAX_FIELDS];
+    for (const char* line = begin; line < end; )
+    {
+        const char* lineEnd = csvLineEnd(line, end);
+        fields += csvSplit(line, lineEnd, row);
+        line = lineEnd + 1;
+    }
+    double seconds = secondsSince(start);
+    cout << "  per-character  " << megabytes / seconds << " MB/s  (" << fields << " fields)" << endl;
+
+    // Structural index with every kernel the CPU supports
+    CsvKernel kernels[] = { CSV_SCALAR, CSV_SSE2, CSV_AVX2 };
+    for (int k = 0; k < 3 && kernels[k] <= csvBestKernel(); ++k)
+    {
+        start = chrono::steady_clock::now();
+        long long separators = 0;
+        for (const char* p = begin; p < end; )
+        {
+            const char* next = (size_t)(end - p) > chunk ? csvLineEnd(p + chunk, end) + 1 : end; // Cut at a line boundary
+            MyVector<unsigned> offsets;
+            csvIndex(p, next, offsets, kernels[k]);
+            separators += offsets.size();
+            p = next;
+        }
+        seconds = secondsSince(start);
+        // Every field ends at a separator, the last line has a newline
+        cout << "  index/" << csvKernelName(kernels[k]) << string(8 - string(csvKernelName(kernels[k])).size(), ' ')
+             << megabytes / seconds << " MB/s  (" << separators << " fields)" << endl;
+    }
+}
+
+// Append and commit borrow records from several threads at once, one commit per operation
+static void journalRun(const string& path, int ops, int threads)
+{
+    remove(path.c_str());
+    Journal journal(path, 1);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.push_back(thread([&journal, ops, threads, t]
+        {
+            for (int i = t; i < ops; i += threads)
+            {
+                JournalRecord record(JOURNAL_BORROW);
+                record.put(string("Computer Science/Operating Systems")).put(i % 1000).put(string("alice")).put(to_string(i));
+                journal.commit(journal.append(record)); // Acknowledged only once durable
+            }
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); ++t) workers[t].join();
+    double seconds = secondsSince(start);
+    cout << "  " << threads << " thread(s)" << string(threads < 10 ? 4 : 3, ' ') << ops / seconds << " ops/s  ("
+         << journal.syncs() << " syncs, " << (double)ops / journal.syncs() << " records per sync)" << endl;
+}
+
+static void benchJournal(int ops)
+{
+    string path = "bench.journal"; // Next to the binary, on the disk being measured
+    cout << "journal: " << ops << " borrow records, each committed before it is acknowledged" << endl;
+    int threadCounts[] = { 1, 4, 16, 64 };
+    for (int i = 0; i < 4; ++i)
+    {
+        journalRun(path, threadCounts[i] == 1 ? ops / 10 : ops, threadCounts[i]); // A sync per record is slow, run fewer
+    }
+
+    // A batch, like the rows of an import: queue every record and wait once
+    remove(path.c_str());
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    {
+        Journal journal(path, 1);
+        uint64_t last = 0;
+        for (int i = 0; i < ops; ++i)
+        {
+            JournalRecord record(JOURNAL_BORROW);
+            record.put(string("Computer Science/Operating Systems")).put(i % 1000).put(string("alice")).put(to_string(i));
+            last = journal.append(record);
+        }
+        journal.commit(last);
+        double seconds = secondsSince(start);
+        cout << "  batch        " << ops / seconds << " ops/s  (" << journal.syncs() << " syncs)" << endl;
+    }
+
+    start = chrono::steady_clock::now();
+    long long replayed = 0;
+    Journal::replay(path, 0, [&replayed](JournalRecord& record) { replayed++; });
+    double seconds = secondsSince(start);
+    cout << "  replay       " << replayed / seconds << " records/s" << endl;
+    remove(path.c_str());
+}
+
+// One pass of the workloads the catalog puts on its vectors, timed per workload
+template<typename V, typename S> static void vectorRun(int n, double* seconds)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    V pointers;
+    for (int i = 0; i < n; ++i) pointers.push_back(&seconds[i % 5]); // Child and book lists hold pointers
+    seconds[0] = secondsSince(start);
+
+    start = chrono::steady_clock::now();
+    S strings;
+    for (int i = 0; i < n; ++i)
+    {
+        string title = "Operating System Concepts, Vol " + to_string(i);
+        strings.push_back(move(title)); // Import rows hand over their fields
+    }
+    seconds[1] = secondsSince(start);
+
+    start = chrono::steady_clock::now();
+    S emplaced;
+    emplaced.reserve(n);
+    for (int i = 0; i < n; ++i) emplaced.emplace_back(32, 'x');
+    seconds[2] = secondsSince(start);
+
+    start = chrono::steady_clock::now();
+    size_t sum = 0;
+    for (int pass = 0; pass < 10; ++pass)
+    {
+        for (auto p : pointers) sum += (size_t)p & 0xff; // Tree walks iterate the lists
+    }
+    seconds[3] = secondsSince(start);
+
+    start = chrono::steady_clock::now();
+    S copy(strings);
+    V copies(pointers);
+    seconds[4] = secondsSince(start);
+    if (sum == 1 || copy.size() + copies.size() == 0) cout << ""; // Keep the work observable
+}
+
+static void benchVector(int n)
+{
+    cout << "vector: " << n << " elements per workload, MyVector against std::vector" << endl;
+    double mine[5], standard[5], run[5];
+    for (int i = 0; i < 5; ++i) mine[i] = standard[i] = 1e9;
+    for (int round = 0; round < 3; ++round) // Alternate and keep the best, so neither pays for a cold allocator
+    {
+        vectorRun<MyVector<double*>, MyVector<string> >(n, run);
+        for (int i = 0; i < 5; ++i) mine[i] = min(mine[i], run[i]);
+        vectorRun<vector<double*>, vector<string> >(n, run);
+        for (int i = 0; i < 5; ++i) standard[i] = min(standard[i], run[i]);
+    }
+    const char* names[] = { "push_back ptr", "push_back move", "emplace_back", "range-for x10", "copy" };
+    for (int i = 0; i < 5; ++i)
+    {
+        cout << "  " << names[i] << string(16 - string(names[i]).size(), ' ') << mine[i] * 1000 << " ms  vs  "
+             << standard[i] * 1000 << " ms" << endl;
+    }
+}
+
+// Resident size of this process in KB, read from /proc (Linux)
+static long residentKb()
+{
+    long pages = 0, resident = 0;
+    ifstream statm("/proc/self/statm");
+    statm >> pages >> resident;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// The per-book borrower history and the loan lists of a catalog of n books, built with a
+// given list type. Histories hold 0 to 3 borrowers, a third of the books are on loan.
+template<typename History, typename LoanList> static void listsRun(const char* name, int n)
+{
+    pid_t child = fork(); // Each layout is measured in a fresh process, so freed memory is not reused
+    if (child == 0)
+    {
+        long before = residentKb();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        History* histories = new History[n];
+        unordered_map<int, LoanList> byBook;
+        unordered_map<int, LoanList> byBorrower;
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = 0; j < i % 4; ++j) histories[i].push_back(&histories[(i + j) % n]);
+            if (i % 3 == 0)
+            {
+                byBook[i].push_back(i);
+                byBorrower[i % (n / 4 + 1)].push_back(i); // Four books per borrower on average
+            }
+        }
+        double seconds = secondsSince(start);
+        cout << "  " << name << string(12 - string(name).size(), ' ') << residentKb() - before << " KB resident  ("
+             << sizeof(History) << " bytes per history, built in " << seconds * 1000 << " ms)" << endl;
+        _exit(0);
+    }
+    waitpid(child, nullptr, 0);
+}
+
+static void benchLists(int n)
+{
+    cout << "lists: borrower histories and loan lists of " << n << " books" << endl;
+    cout.flush(); // The children write to the same stream
+    listsRun<MyVector<void*>, MyVector<int> >("MyVector", n);
+    listsRun<SmallVector<void*, 2>, SmallVector<int, 3> >("SmallVector", n);
+}
+
+// The book record as it was before the compact layout: three strings, three ints, a borrower list
+struct LegacyBook
+{
+    string title;
+    string author;
+    string isbn;
+    int publication_year;
+    int total_copies;
+    int available_copies;
+    SmallVector<void*, 2> allBorrowers;
+    void* node;
+};
+
+// Heap bytes a string holds beyond its object
+static size_t stringHeap(const string& text)
+{
+    return (text.capacity() > 15) ? text.capacity() + 1 : 0;
+}
+
+static void benchBooks(int n)
+{
+    static const char* authors[] = { "Donald Knuth", "Abraham Silberschatz, Peter Galvin", "Michael Artin", "J. R. R. Tolkien" };
+    cout << "books: " << n << " records, scanned in catalog order" << endl;
+    vector<string> titles, isbns;
+    for (int i = 0; i < n; ++i)
+    {
+        titles.push_back("Operating System Concepts, Volume " + to_string(i));
+        isbns.push_back((i % 2) ? to_string(9780000000000LL + i) : "978-0-" + to_string(100000 + i % 900000) + "-1"); // Half bare, half formatted
+    }
+    string needle = "Operating System Concepts, Volume " + to_string(n - 1); // A findBook that reaches the last book
+
+    // Before: records with their own strings
+    {
+        Pool<LegacyBook> pool;
+        vector<LegacyBook*> books;
+        size_t heap = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            LegacyBook* book = pool.create();
+            book->title = titles[i];
+            book->author = authors[i % 4];
+            book->isbn = isbns[i];
+            book->publication_year = 1950 + i % 70;
+            book->total_copies = 1 + i % 5;
+            book->available_copies = i % 2;
+            book->node = nullptr;
+            heap += stringHeap(book->title) + stringHeap(book->author) + stringHeap(book->isbn);
+            books.push_back(book);
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        long long hits = 0;
+        for (int i = 0; i < n; ++i) if (books[i]->publication_year >= 2000 && books[i]->available_copies > 0) hits++;
+        double filter = secondsSince(start);
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i) if (books[i]->title == needle) hits++;
+        double find = secondsSince(start);
+        cout << "  before  " << sizeof(LegacyBook) + heap / n << " bytes/book (" << sizeof(LegacyBook) << " + heap)  year filter "
+             << filter * 1000 << " ms  title scan " << find * 1000 << " ms  (" << hits << ")" << endl;
+    }
+
+    // After: compact records, titles in an arena
+    {
+        Pool<Book> pool;
+        TextArena arena;
+        vector<Book*> books;
+        for (int i = 0; i < n; ++i)
+        {
+            books.push_back(pool.create(arena, titles[i], authors[i % 4], isbns[i], 1950 + i % 70, 1 + i % 5, i % 2));
+        }
+        size_t heap = arena.bytes() + Isbn::pool().bytes() + Book::authors.bytes();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        long long hits = 0;
+        for (int i = 0; i < n; ++i) if (books[i]->getYear() >= 2000 && books[i]->getAvailableCopies() > 0) hits++;
+        double filter = secondsSince(start);
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i)
+        {
+            const char* title = books[i]->getTitle();
+            if (TextArena::length(title) == needle.size() && memcmp(title, needle.data(), needle.size()) == 0) hits++;
+        }
+        double find = secondsSince(start);
+        cout << "  after   " << sizeof(Book) + heap / n << " bytes/book (" << sizeof(Book) << " + arena and pools)  year filter "
+             << filter * 1000 << " ms  title scan " << find * 1000 << " ms  (" << hits << ")" << endl;
+    }
+}
+
+// A category node as it was before the flat layout: its own heap lists of children and books
+struct LegacyNode
+{
+    MyVector<LegacyNode*> children;
+    MyVector<Book*> books;
+};
+
+// Sum of the years of the books of a subtree, walking the pointer graph like the old printAll
+static long long legacyScan(LegacyNode* node)
+{
+    long long sum = 0;
+    for (int i = 0; i < node->books.size(); ++i) sum += node->books[i]->getYear();
+    for (int i = 0; i < node->children.size(); ++i) sum += legacyScan(node->children[i]);
+    return sum;
+}
+
+// Book count of a subtree, bottom-up like the old recountBooks
+static unsigned int legacyCount(LegacyNode* node)
+{
+    unsigned int count = node->books.size();
+    for (int i = 0; i < node->children.size(); ++i) count += legacyCount(node->children[i]);
+    return count;
+}
+
+// Sum of the years of a range of the flat layout's books
+static long long flatScan(const FlatTree& flat, uint32_t id)
+{
+    long long sum = 0;
+    uint32_t end = flat.bookEnd(id);
+    for (uint32_t i = flat.bookBegin(id); i < end; ++i) sum += flat.book(i)->getYear();
+    return sum;
+}
+
+static void benchTree(int n)
+{
+    cout << "tree: " << n << " books in 50 categories x 50 x 50, added in random category order" << endl;
+    Tree tree("Library");
+    Pool<LegacyNode> legacyPool;
+    LegacyNode* legacyRoot = legacyPool.create();
+    vector<Node*> nodes;
+    vector<LegacyNode*> legacy;
+    for (int a = 0; a < 50; ++a) // Same shape in both trees, nodes created in the same order
+    {
+        LegacyNode* top = legacyPool.create();
+        legacyRoot->children.push_back(top);
+        for (int b = 0; b < 50; ++b)
+        {
+            LegacyNode* mid = legacyPool.create();
+            top->children.push_back(mid);
+            for (int c = 0; c < 50; ++c)
+            {
+                LegacyNode* leaf = legacyPool.create();
+                mid->children.push_back(leaf);
+                nodes.push_back(tree.createNode("C" + to_string(a) + "/S" + to_string(b) + "/L" + to_string(c)));
+                legacy.push_back(leaf);
+            }
+        }
+    }
+    unsigned int seed = 12345;
+    for (int i = 0; i < n; ++i) // Import order: every book lands in an unrelated category
+    {
+        seed = seed * 1103515245 + 12345;
+        int k = (seed >> 8) % nodes.size();
+        Book* book = tree.getBookPool().create(tree.getTitleArena(), "Title " + to_string(i), "Author", "9780000000000", 1950 + i % 70, 1, 1);
+        tree.addBook(nodes[k], book);
+        legacy[k]->books.push_back(book);
+    }
+
+    double best[5] = { 1e9, 1e9, 1e9, 1e9, 1e9 }; // pointer scan, flat scan, pointer counts, flat counts, layout build
+    long long check = 0;
+    for (int round = 0; round < 3; ++round) // Keep the best, so neither layout pays for a cold cache
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        FlatTree flat;
+        flat.build(tree.getRoot(), 1);
+        best[4] = min(best[4], secondsSince(start));
+
+        start = chrono::steady_clock::now();
+        long long sum = legacyScan(legacyRoot);
+        for (int i = 0; i < legacyRoot->children.size(); ++i) sum += legacyScan(legacyRoot->children[i]); // findAll of each category
+        best[0] = min(best[0], secondsSince(start));
+
+        start = chrono::steady_clock::now();
+        long long flatSum = flatScan(flat, 0);
+        for (uint32_t id = 1; id < flat.size(); ++id) if (flat[id].parent == 0) flatSum += flatScan(flat, id);
+        best[1] = min(best[1], secondsSince(start));
+
+        start = chrono::steady_clock::now();
+        unsigned int count = legacyCount(legacyRoot);
+        best[2] = min(best[2], secondsSince(start));
+
+        start = chrono::steady_clock::now();
+        unsigned int flatCount = 0;
+        for (uint32_t id = 0; id < flat.size(); ++id) flatCount += flat.subtreeBooks(id);
+        best[3] = min(best[3], secondsSince(start));
+
+        if (sum != flatSum || count != flat.subtreeBooks(0)) cout << "  mismatch!" << endl;
+        check += sum + flatCount;
+    }
+    cout << "  subtree scans   pointer " << best[0] * 1000 << " ms  flat " << best[1] * 1000 << " ms" << endl;
+    cout << "  book counts     pointer " << best[2] * 1000 << " ms  flat " << best[3] * 1000 << " ms" << endl;
+    cout << "  layout build    " << best[4] * 1000 << " ms  (" << check % 10 << ")" << endl;
+}
+
+static void benchScan(int n)
+{
+    int cores = thread::hardware_concurrency();
+    cout << "scan: export of " << n << " books in 50 categories x 50 x 50, " << cores << " core(s)" << endl;
+    Tree tree("Library");
+    vector<Node*> nodes;
+    for (int a = 0; a < 50; ++a)
+        for (int b = 0; b < 50; ++b)
+            for (int c = 0; c < 50; ++c)
+                nodes.push_back(tree.createNode("C" + to_string(a) + "/S" + to_string(b) + "/L" + to_string(c)));
+    unsigned int seed = 12345;
+    for (int i = 0; i < n; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        Book* book = tree.getBookPool().create(tree.getTitleArena(), "Title, part " + to_string(i), "Author " + to_string(i % 1000),
+                                               to_string(9780000000000LL + i), 1950 + i % 70, 1 + i % 5, i % 3);
+        tree.addBook(nodes[(seed >> 8) % nodes.size()], book);
+    }
+    tree.recountBooks(); // Lays the tree out before the first timed run
+    const char* path = "bench_export.csv";
+
+    // Before: fields streamed one by one, every row ended with endl, a category path per node
+    {
+        const FlatTree& flat = tree.layout();
+        ofstream out(path);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (uint32_t id = 0; id < flat.size(); ++id)
+        {
+            string category = flat[id].node->getCategory(flat[id].node);
+            for (uint32_t i = flat[id].firstBook; i < flat[id].firstBook + flat[id].ownBooks; ++i)
+            {
+                Book* book = flat.book(i);
+                if (strchr(book->getTitle(), ',') != nullptr) out << '"' << book->getTitle() << '"' << ',';
+                else out << book->getTitle() << ',';
+                if (book->getAuthor().find(',') != string::npos) out << '"' << book->getAuthor() << '"' << ',';
+                else out << book->getAuthor() << ',';
+                out << book->getIsbn().str() << ',';
+                out << to_string(book->getYear()) << ',' << "," << category << ',';
+                out << to_string(book->getTotalCopies()) << ',';
+                out << to_string(book->getAvailableCopies()) << endl;
+            }
+        }
+        out.close();
+        cout << "  ofstream << endl       " << secondsSince(start) * 1000 << " ms" << endl;
+    }
+
+    // After: rows formatted into task buffers, written a wave at a time
+    double single = 0;
+    for (int threads = 1; threads <= max(cores, 8); threads *= 2)
+    {
+        double best = 1e9;
+        for (int round = 0; round < 3; ++round)
+        {
+            ofstream out(path);
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            tree.exportData(tree.getRoot(), out, threads);
+            best = min(best, secondsSince(start));
+        }
+        if (threads == 1) single = best;
+        cout << "  buffered, " << threads << " thread(s)  " << best * 1000 << " ms  speedup " << single / best << "x" << endl;
+    }
+    remove(path);
+}
+
+// Lower-cased words of a text, the way the text index cuts them
+static vector<string> scanWords(const string& text)
+{
+    vector<string> words(1);
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        unsigned char c = text[i];
+        if (isalnum(c) || c >= 0x80) words.back() += static_cast<char>(tolower(c));
+        else if (!words.back().empty()) words.push_back("");
+    }
+    if (words.back().empty()) words.pop_back();
+    return words;
+}
+
+// Whether a book has every word of a query, by reading its title and author like a full scan would
+static bool scanMatch(Book* book, const vector<string>& query)
+{
+    vector<string> words = scanWords(string(book->getTitle()) + " " + book->getAuthor());
+    for (size_t q = 0; q < query.size(); ++q)
+    {
+        if (find(words.begin(), words.end(), query[q]) == words.end()) return false;
+    }
+    return true;
+}
+
+static void benchSearch(int n)
+{
+    cout << "search: " << n << " books, titles of 3 words out of 2000 (skewed) and a number, 1000 authors" << endl;
+    Tree tree("Library");
+    Node* node = tree.createNode("General");
+    vector<Book*> books;
+    unsigned int seed = 12345;
+    for (int i = 0; i < n; ++i)
+    {
+        string title;
+        for (int w = 0; w < 3; ++w) // Squaring skews the draw toward the first words, as in real titles
+        {
+            seed = seed * 1103515245 + 12345;
+            unsigned int r = (seed >> 8) % 2000;
+            title += "word" + to_string(r * r / 2000) + " ";
+        }
+        title += to_string(i);
+        Book* book = tree.getBookPool().create(tree.getTitleArena(), title, "Author " + to_string(i % 1000), "9780000000000", 2000, 1, 1);
+        tree.addBook(node, book);
+        books.push_back(book);
+    }
+
+    TextIndex index;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) index.add(books[i]);
+    double build = secondsSince(start);
+    cout << "  index build     " << build * 1000 << " ms (" << build * 1e9 / n << " ns/book), " << index.terms() << " words, "
+         << index.bytes() / (1 << 20) << " MB" << endl;
+
+    const char* queries[] = { "word0 word1", "word5 word900", "word3 author 7", "word1280 word1805", "word0 word1 word2",
+                              "word1999 OR word1998", "author 42 word0" };
+    int count = sizeof(queries) / sizeof(queries[0]);
+    for (int q = 0; q < count; ++q)
+    {
+        vector<string> words = scanWords(queries[q]);
+        bool alternatives = strstr(queries[q], " OR ") != nullptr;
+        start = chrono::steady_clock::now();
+        size_t scanned = 0;
+        for (int i = 0; i < n; ++i) // Before: every title and author read for each query
+        {
+            if (alternatives) scanned += scanMatch(books[i], vector<string>(1, words[0])) || scanMatch(books[i], vector<string>(1, words[2]));
+            else scanned += scanMatch(books[i], words);
+        }
+        double scan = secondsSince(start);
+
+        MyVector<Book*> found;
+        double best = 1e9;
+        for (int round = 0; round < 5; ++round)
+        {
+            start = chrono::steady_clock::now();
+            index.search(queries[q], found);
+            best = min(best, secondsSince(start));
+        }
+        cout << "  \"" << queries[q] << "\"" << string(22 - strlen(queries[q]), ' ') << found.size() << " books  scan " << scan * 1000
+             << " ms  index " << best * 1e6 << " us" << (static_cast<size_t>(found.size()) == scanned ? "" : "  mismatch!") << endl;
+    }
+}
+
+// Edits from a to b, a swap of two neighbours counting as one, bound + 1 once past bound, for the full scan fuzzyFind replaces
+static int scanDistance(const string& a, const string& b, int bound)
+{
+    if (abs(static_cast<int>(a.size()) - static_cast<int>(b.size())) > bound) return bound + 1;
+    vector<int> before(b.size() + 1), previous(b.size() + 1), current(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); ++j) previous[j] = j;
+    for (size_t i = 1; i <= a.size(); ++i)
+    {
+        current[0] = i;
+        int best = i;
+        for (size_t j = 1; j <= b.size(); ++j)
+        {
+            current[j] = min(previous[j - 1] + (a[i - 1] != b[j - 1]), min(previous[j], current[j - 1]) + 1);
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) current[j] = min(current[j], before[j - 2] + 1);
+            best = min(best, current[j]);
+        }
+        if (best > bound) return bound + 1;
+        before.swap(previous);
+        previous.swap(current);
+    }
+    return previous[b.size()];
+}
+
+// A made-up word of two or three syllables, so titles share trigrams the way words of a language do
+static string syllableWord(unsigned int w)
+{
+    static const char* syllables[] = { "ka", "lor", "mi", "ten", "su", "bra", "vel", "do", "rin", "pha", "go", "stu", "e", "wan", "qui", "zo",
+                                       "ner", "ta", "lis", "mon" };
+    string word = string(syllables[w % 20]) + syllables[(w / 20) % 20];
+    if (w >= 400) word += syllables[(w / 400) % 20];
+    return word;
+}
+
+static void benchFuzzy(int n)
+{
+    cout << "fuzzy: long titles with two typing errors and short ones with one, among n titles of 3 made-up words out of 8000 and a number" << endl;
+    const int count = 7, longCount = 4;
+    string titles[count] = { "", "", "", "", "don", "it", "dune" }; // Short titles share too few trigrams to be found through them
+    string typos[count] = { "", "", "", "", "dan", "is", "dnue" };
+    for (int q = 0; q < longCount; ++q) // The titles the queries mistype: a letter dropped, one doubled
+    {
+        titles[q] = syllableWord(q * 1999 + 7) + " " + syllableWord(q * 733 + 401) + " " + syllableWord(q * 97 + 3000) + " " + to_string(1000 + q);
+        typos[q] = titles[q];
+        typos[q].erase(2, 1);
+        typos[q].insert(typos[q].size() - 6, 1, typos[q][typos[q].size() - 6]);
+    }
+    for (int size = n / 10; size <= n; size *= 10) // The same queries on a catalog ten times larger
+    {
+        Tree tree("Library");
+        Node* node = tree.createNode("General");
+        vector<Book*> books;
+        unsigned int seed = 12345;
+        for (int i = 0; i < size; ++i)
+        {
+            string title;
+            for (int w = 0; w < 3; ++w)
+            {
+                seed = seed * 1103515245 + 12345;
+                title += syllableWord((seed >> 8) % 8000) + " ";
+            }
+            title += to_string(i);
+            if (i < count) title = titles[i];
+            Book* book = tree.getBookPool().create(tree.getTitleArena(), title, "Author", "9780000000000", 2000, 1, 1);
+            tree.addBook(node, book);
+            books.push_back(book);
+        }
+
+        TextIndex index;
+        for (int i = 0; i < size; ++i) index.add(books[i]);
+        MyVector<TextIndex::Match> matches;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        index.fuzzy("warmup", 10, matches); // Fills the trigram lists
+        double build = secondsSince(start);
+
+        double scan = 0, best = 0;
+        for (int q = 0; q < count; ++q)
+        {
+            start = chrono::steady_clock::now();
+            int bound = min(3, 1 + static_cast<int>(typos[q].size()) / 8), scanned = 0;
+            for (int i = 0; i < size; ++i) scanned += scanDistance(typos[q], books[i]->getTitle(), bound) <= bound; // Before: every title compared
+            scan += secondsSince(start);
+
+            double fastest = 1e9;
+            for (int round = 0; round < 5; ++round)
+            {
+                start = chrono::steady_clock::now();
+                index.fuzzy(typos[q], 10, matches);
+                fastest = min(fastest, secondsSince(start));
+            }
+            best += fastest;
+            if (matches.size() != min(scanned, 10)) cout << "  mismatch on \"" << typos[q] << "\"" << endl;
+        }
+        cout << "  " << size << " titles  trigram lists " << build * 1000 << " ms  scan " << scan / count * 1000 << " ms/query  index "
+             << best / count * 1e6 << " us/query" << endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    string name = (argc > 1) ? argv[1] : "";
+    int size = (argc > 2) ? atoi(argv[2]) : 0;
+
+    if (name == "csv") benchCsv(size > 0 ? size : 256);
+    else if (name == "journal") benchJournal(size > 0 ? size : 200000);
+    else if (name == "vector") benchVector(size > 0 ? size : 2000000);
+    else if (name == "lists") benchLists(size > 0 ? size : 1000000);
+    else if (name == "books") benchBooks(size > 0 ? size : 1000000);
+    else if (name == "tree") benchTree(size > 0 ? size : 1000000);
+    else if (name == "scan") benchScan(size > 0 ? size : 1000000);
+    else if (name == "search") benchSearch(size > 0 ? size : 1000000);
+    else if (name == "fuzzy") benchFuzzy(size > 0 ? size : 1000000);
+    else
+    {
+        cout << "usage: ./bench <name> [size]" << endl
+             << "  csv [MB]       CSV tokenizer throughput (default 256 MB)" << endl
+             << "  journal [ops]  journal group commit throughput (default 200000 operations)" << endl
+             << "  vector [n]     MyVector against std::vector (default 2000000 elements)" << endl
+             << "  lists [books]  resident size of per-book lists, heap against inline (default 1000000 books)" << endl
+             << "  books [n]      footprint and scan time of the book record, before and after the compact layout (default 1000000)" << endl
+             << "  tree [books]   subtree scans and book counts, pointer tree against the flat layout (default 1000000)" << endl
+             << "  scan [books]   export time, streamed row by row and buffered with 1, 2, 4... threads (default 1000000)" << endl
+             << "  search [books] word queries, full scan against the text index (default 1000000)" << endl
+             << "  fuzzy [books]  typo-tolerant title lookups, full scan against the trigram lists, at books/10 and books (default 1000000)" << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
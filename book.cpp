@@ -7,20 +7,52 @@
 // Description  : 
 //============================================================================
 #include "book.h" // Include the header file for the Book class
+#include "textindex.h"
+#include <utility>
+#include <stdexcept>
 
-// Constructor for the Book class with initialization list
-Book::Book(std::string title, std::string author, std::string isbn, int publication_year, int total_copies, int available_copies)
+StringPool Book::authors; // Shared by every book of every catalog
+
+// Constructor for the Book class; the title is copied into the given arena
+Book::Book(TextArena& titles, const std::string& title, const std::string& author, const std::string& isbn, int publication_year, int total_copies, int available_copies)
+    : isbn(isbn) // Pack the ISBN of the book
 {
-    this->title = title; // Initialize the title of the book
-    this->author = author; // Initialize the author(s) of the book
-    this->isbn = isbn; // Initialize the ISBN of the book
-    this->publication_year = publication_year; // Initialize the publication year of the book
+    this->publication_year = toYear(publication_year); // Initialize the publication year of the book, checked first so nothing is stored for a bad row
+    this->title = titles.add(title); // Initialize the title of the book
+    this->author = authors.intern(author); // Initialize the author(s) of the book, sharing the pool's copy
     this->total_copies = total_copies; // Initialize the total copies of the book
     this->available_copies = available_copies; // Initialize the available copies of the book
+    this->node = nullptr; // The owning category is set when the book is placed in the tree
+    this->textId = TextIndex::NONE; // Not in the text index until the catalog indexes it
+}
+
+// Method to check that a publication year fits the 16 bits a book keeps for it
+int16_t Book::toYear(int year)
+{
+    if (year < INT16_MIN || year > INT16_MAX)
+    {
+        throw out_of_range("Publication year " + to_string(year) + " is out of range");
+    }
+    return static_cast<int16_t>(year);
+}
+
+// Method to replace the title of the book
+void Book::setTitle(TextArena& titles, const std::string& title)
+{
+    const char* old = this->title;
+    this->title = titles.add(title); // Copy first, the old title stays valid until then
+    titles.release(old);
 }
 
 // Method to display the details of a book
 void Book :: display() 
+{
+    display(title, *author, isbn.str(), publication_year, total_copies, available_copies);
+}
+
+// Method to display the details of a book given field by field, also used for books of a mapped snapshot
+void Book :: display(const std::string& title, const std::string& author, const std::string& isbn,
+                     int publication_year, int total_copies, int available_copies)
 {
     cout << "===================================================================================================" << endl; // Print separator line
     cout << "Title: " << title << endl; // Display the title of the book
@@ -9,28 +9,49 @@
 #ifndef _BOOK_H
 #define _BOOK_H
 #include<string>
+#include<cstdint>
 #include "myvector.h"
+#include "stringpool.h"
+#include "textarena.h"
+#include "isbn.h"
 class Borrower;
+class Node;
+
+// A Book is kept to 48 bytes: its title lives in the tree's title arena, its author in the
+// author pool, its ISBN in 64 bits and its borrower history in the loan table (books that
+// never circulated have none). Books own no memory, so a pool drops them without a visit.
 class Book
 {
 	private:
-		std::string title;
-		std::string author;
-		std::string isbn;
-		int publication_year;
-		int total_copies;
-		int available_copies;
-		MyVector<Borrower*> currentBorrowers;		//current borrowers of the book
-		MyVector<Borrower*> allBorrowers;   //history of all borrowers of the book
+		const char* title;					//title, NUL-terminated in the tree's title arena
+		const std::string* author;			//interned author(s), equal authors share one handle
+		Isbn isbn;							//packed ISBN, or the interned text of a formatted one
+		Node* node;							//category node that holds the book
+		int32_t total_copies;
+		int32_t available_copies;
+		int16_t publication_year;
+		uint32_t textId;					//id in the catalog's text index, in the padding after the year
 
 	public:
-		Book(std::string title, std::string author, std::string isbn, int publication_year,int total_copies, int available_copies);
+		Book(TextArena& titles, const std::string& title, const std::string& author, const std::string& isbn, int publication_year, int total_copies, int available_copies);
 		void display(); // display details of a book (see output of command findbook)
+		static void display(const std::string& title, const std::string& author, const std::string& isbn,
+		                    int publication_year, int total_copies, int available_copies);	//display details given as fields
+		const char* getTitle() const { return title; }	//title of the book, NUL-terminated
+		const std::string& getAuthor() const { return *author; }	//author(s) of the book, interned
+		const Isbn& getIsbn() const { return isbn; }	//ISBN of the book
+		int getYear() const { return publication_year; }	//publication year of the book
+		int getTotalCopies() const { return total_copies; }	//copies the library owns
+		int getAvailableCopies() const { return available_copies; }	//copies on the shelf
+		void setTitle(TextArena& titles, const std::string& title);	//replace the title, the old one becomes dead arena bytes
+		static int16_t toYear(int year);	//check that a publication year fits the record, throws out_of_range otherwise
+		static StringPool authors;			//the authors of every book, interned
 
 	public:
 		friend class Tree;
 		friend class Node;
 		friend class LCMS;
 		friend class Borrower;
+		friend class TextIndex;
 };
-#endif
\ No newline at end of file
+#endif
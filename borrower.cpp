@@ -16,11 +16,11 @@ Borrower :: Borrower(string name, string id)
 }
 
 // Method to list the books borrowed by the borrower
-void Borrower :: listBooks()
+void Borrower :: listBooks(LoanTable& loans)
 {
 	cout << "Books borrowed by " << name << " (" << id << "): " << endl; // Print the borrower's name and ID
-	for(int i = 0; i < books_borrowed.size(); i++) // Iterate through the list of borrowed books
+	for(int i = 0; i < loans.countByBorrower(this); i++) // Iterate through the loans of the borrower
 	{
-		cout << i + 1 << ": " << books_borrowed[i]->title << endl; // Print each book's title with its number in the list
+		cout << i + 1 << ": " << loans.bookAt(this, i)->title << endl; // Print each book's title with its number in the list
 	}
 }
@@ -10,6 +10,7 @@
 #define _BORROWER_H
 #include "myvector.h"
 #include "book.h"
+#include "loan.h"
 
 
 class Borrower
@@ -17,12 +18,11 @@ class Borrower
 	private:
 		string name;
 		string id;
-		MyVector<Book*> books_borrowed;
 	public:
 		Borrower(string name, string id);
 		friend class LCMS;
 		friend class Tree;
 		friend class Book;
-		void listBooks();
+		void listBooks(LoanTable& loans);	//books currently held, as recorded in the loan table
 };
 #endif
@@ -0,0 +1,170 @@
+//============================================================================
+// Name         : catalogview.cpp
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : 
+//============================================================================
+#include <iostream>
+#include <cstring>
+#include <stdexcept>
+#include "catalogview.h" // Include the header file for the CatalogView class
+#include "book.h"
+using namespace std;
+
+// Constructor: map and validate the snapshot; the tables stay in the file
+CatalogView::CatalogView(const string& path) : file(path), snap(file), path(path)
+{
+    if (snap.titles == nullptr) // Version 1 snapshots have no title table to search in place
+    {
+        throw runtime_error("Snapshot " + path + " has no title index, load it and save it again to open it read-only");
+    }
+}
+
+// Method to get the path the view was opened from
+const string& CatalogView::getPath() const
+{
+    return path;
+}
+
+// Method to get the number of books of the catalog
+uint32_t CatalogView::bookCount() const
+{
+    return snap.header->bookCount;
+}
+
+// Method to find the child of a node with a given name; the children of a node follow it
+// in pre-order and each one's subtree ends where the next sibling starts
+uint32_t CatalogView::findChild(uint32_t node, const string& name) const
+{
+    for (uint32_t child = node + 1; child < snap.nodes[node].subtreeEnd; child = snap.nodes[child].subtreeEnd)
+    {
+        const SnapString& ref = snap.nodes[child].name;
+        if (ref.length == name.size() && memcmp(snap.text(ref), name.data(), ref.length) == 0)
+        {
+            return child;
+        }
+    }
+    return SNAPSHOT_NONE;
+}
+
+// Method to find a node given a path in the format category/sub-category/..., like Tree::getNode
+uint32_t CatalogView::findNode(const string& category) const
+{
+    size_t start = (!category.empty() && category[0] == '/') ? 1 : 0; // "/A/B" and "A/B" name the same node
+    uint32_t node = 0; // Start from the root node
+    while (true)
+    {
+        size_t end = category.find('/', start); // Delimit the next segment
+        node = findChild(node, category.substr(start, end == string::npos ? string::npos : end - start));
+        if (node == SNAPSHOT_NONE || end == string::npos) return node;
+        start = end + 1; // Move past the '/'
+    }
+}
+
+// Method to find a book by title with a binary search of the title table
+void CatalogView::findBook(const string& title) const
+{
+    const uint32_t* first = snap.titles;
+    uint32_t count = snap.header->bookCount;
+    while (count > 0) // Lower bound: the first book in file order wins, as in the loaded catalog
+    {
+        uint32_t half = count / 2;
+        const SnapString& ref = snap.books[first[half]].title;
+        size_t common = min<size_t>(ref.length, title.size());
+        int order = memcmp(snap.text(ref), title.data(), common);
+        if (order < 0 || (order == 0 && ref.length < title.size()))
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+
+    const SnapBook* entry = (first != snap.titles + snap.header->bookCount) ? &snap.books[*first] : nullptr;
+    if (entry != nullptr && entry->title.length == title.size() && memcmp(snap.text(entry->title), title.data(), title.size()) == 0)
+    {
+        cout << "Book found in the library:" << endl;
+        Book::display(snap.str(entry->title), snap.str(entry->author), snap.str(entry->isbn), // Only the book shown is copied out
+                      entry->publicationYear, entry->totalCopies, entry->availableCopies);
+    }
+    else
+    {
+        cout << "Book not found in the library." << endl; // Print a message if the book is not found
+    }
+}
+
+// Method to print a book the way Tree::printAll does
+void CatalogView::printBook(uint32_t index) const
+{
+    const SnapBook& book = snap.books[index];
+    cout << "Title: " << snap.str(book.title) << endl;
+    cout << "Author(s): " << snap.str(book.author) << endl;
+    cout << "ISBN: " << snap.str(book.isbn) << endl;
+    cout << "Year: " << book.publicationYear << endl;
+    cout << "=====================================================================================================" << endl;
+}
+
+// Method to display all books of a category; a subtree's books are one contiguous range
+void CatalogView::findAll(const string& category) const
+{
+    uint32_t node = findNode(category);
+    if (node == SNAPSHOT_NONE) // If the category does not exist
+    {
+        cout << "Category " << category << " does not exist" << endl;
+        return;
+    }
+    uint32_t end = snap.nodes[node].subtreeEnd;
+    uint32_t lastBook = (end < snap.header->nodeCount) ? snap.nodes[end].firstBook : snap.header->bookCount;
+    for (uint32_t i = snap.nodes[node].firstBook; i < lastBook; i++) // Pre-order, the order of Tree::printAll
+    {
+        printBook(i);
+    }
+    cout << lastBook - snap.nodes[node].firstBook << " records found" << endl; // Print the count of found records
+}
+
+// Method to find a category in the catalog
+void CatalogView::findCategory(const string& category) const
+{
+    if (findNode(category) != SNAPSHOT_NONE)
+    {
+        cout << "Category " << category << " was found in the catalog" << endl;
+    }
+    else
+    {
+        cout << "Category " << category << " was not found in the catalog" << endl;
+    }
+}
+
+// Method to check if a node is the last child of its parent: its subtree ends with its parent's
+bool CatalogView::isLastChild(uint32_t node) const
+{
+    return node != 0 && snap.nodes[node].subtreeEnd == snap.nodes[snap.nodes[node].parent].subtreeEnd;
+}
+
+// Method to print the entire tree structure
+void CatalogView::list() const
+{
+    print_helper("", "", 0); // Start the recursive printing from the root node
+}
+
+// Recursive helper method for printing the tree structure, the same layout as Tree::print
+void CatalogView::print_helper(string padding, string pointer, uint32_t node) const
+{
+    const SnapNode& record = snap.nodes[node];
+    uint32_t end = record.subtreeEnd;
+    uint32_t lastBook = (end < snap.header->nodeCount) ? snap.nodes[end].firstBook : snap.header->bookCount;
+    cout << padding << pointer << snap.str(record.name) << "(" << lastBook - record.firstBook << ")" << endl;
+
+    if (node != 0) padding += isLastChild(node) ? "   " : "│  "; // Adjust the padding based on whether the node is the last child
+
+    for (uint32_t child = node + 1; child < end; child = snap.nodes[child].subtreeEnd)
+    {
+        string marker = isLastChild(child) ? "└──" : "├──"; // Choose the correct marker based on whether the child is the last child
+        print_helper(padding, marker, child);
+    }
+}
@@ -0,0 +1,43 @@
+//============================================================================
+// Name         : catalogview.h
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Read-only catalog served straight from a mapped snapshot
+//============================================================================
+#ifndef _CATALOGVIEW_H
+#define _CATALOGVIEW_H
+#include<string>
+#include<stdint.h>
+#include "mappedfile.h"
+#include "snapshot.h"
+using namespace std;
+
+// A CatalogView answers lookups from the tables of a snapshot without building the
+// tree, the books or the indices. Nothing is copied when the view is opened, so it
+// starts in the time of a single pass of validation and costs no heap per book.
+class CatalogView
+{
+	private:
+		MappedFile file;		//the snapshot, mapped read-only
+		SnapshotReader snap;	//validated tables of the snapshot
+		string path;			//path the view was opened from
+
+		uint32_t findNode(const string& category) const;	//index of the node at a path, SNAPSHOT_NONE if none
+		uint32_t findChild(uint32_t node, const string& name) const;	//index of a named child, SNAPSHOT_NONE if none
+		void printBook(uint32_t book) const;		//print a book the way Tree::printAll does
+		void print_helper(string padding, string pointer, uint32_t node) const;
+		bool isLastChild(uint32_t node) const;
+
+	public:
+		CatalogView(const string& path);	//throws runtime_error if the file is not a version 2 snapshot
+		const string& getPath() const;
+		uint32_t bookCount() const;
+
+		void findBook(const string& title) const;		//display the first book carrying a title
+		void findAll(const string& category) const;		//display all books of a category
+		void findCategory(const string& category) const;	//report whether a category exists
+		void list() const;								//display the catalog in tree format
+};
+#endif
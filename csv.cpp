@@ -0,0 +1,222 @@
+//============================================================================
+// Name         : csv.cpp
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : 
+//============================================================================
+#include "csv.h" // Include the header file for the CSV tokenizer
+#include <cstring>
+#include <stdint.h>
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CSV_HAVE_X86 1
+#include <immintrin.h>
+#endif
+using namespace std;
+
+// Method to compare a field with a string without copying the field
+bool FieldView::equals(const string& text) const
+{
+    return text.size() == length && memcmp(text.data(), data, length) == 0;
+}
+
+// Method to parse a field as an integer with the same rules and errors as stoi
+int FieldView::toInt() const
+{
+    return stoi(string(data, length)); // Numeric fields are short, so the string stays in the small-string buffer
+}
+
+// Function to find the end of the line starting at begin
+const char* csvLineEnd(const char* begin, const char* end)
+{
+    const char* newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+    return (newline == nullptr) ? end : newline; // The last line may have no newline
+}
+
+// Function to build a field view, removing surrounding quotes
+FieldView csvField(const char* begin, const char* end)
+{
+    FieldView field = { begin, static_cast<size_t>(end - begin) };
+    if (field.length > 0 && field.data[0] == '"' && field.data[field.length - 1] == '"') // Remove surrounding quotes
+    {
+        field.data++;
+        field.length = (field.length == 1) ? 0 : field.length - 2; // A lone quote becomes an empty field
+    }
+    return field;
+}
+
+// Function to split a line into fields on commas outside quotes
+int csvSplit(const char* begin, const char* end, FieldView* fields)
+{
+    int count = 0; // Number of fields found
+    bool inQuotes = false; // Flag to track whether the current character is within quotes
+    const char* startField = begin; // Start of the current field
+
+    for (const char* p = begin; ; ++p)
+    {
+        // Check for end of line or comma outside quotes, marking the end of a field
+        if (p == end || (*p == ',' && !inQuotes))
+        {
+            if (count < CSV_MAX_FIELDS) fields[count] = csvField(startField, p);
+            count++;
+            if (p == end) break;
+            startField = p + 1; // Set the start of the next field
+        }
+        else if (*p == '"') // Toggle the inQuotes flag on encountering a quote
+        {
+            inQuotes = !inQuotes;
+        }
+    }
+    return count;
+}
+
+// Scalar kernel: one character at a time, the reference for the SIMD kernels
+static void indexScalar(const char* begin, const char* end, MyVector<unsigned>& offsets)
+{
+    bool inQuotes = false;
+    for (const char* p = begin; p < end; ++p)
+    {
+        if (*p == '\n')
+        {
+            offsets.push_back(p - begin);
+            inQuotes = false; // Every line starts outside quotes
+        }
+        else if (*p == ',' && !inQuotes)
+        {
+            offsets.push_back(p - begin);
+        }
+        else if (*p == '"')
+        {
+            inQuotes = !inQuotes;
+        }
+    }
+}
+
+// Bit i of the result is the XOR of bits 0..i of x: set inside quoted regions
+static inline uint64_t prefixXor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// Turn the comma/quote/newline masks of one 64-byte block into structural offsets.
+// inQuotes carries the quote state from the previous block.
+static inline void emitBlock(uint64_t commas, uint64_t quotes, uint64_t newlines, uint64_t& inQuotes, unsigned base, MyVector<unsigned>& offsets)
+{
+    uint64_t quoted = prefixXor(quotes) ^ inQuotes;
+
+    // The quote state resets at every newline: where a line left a quote open, flip everything after its newline
+    uint64_t pending = newlines;
+    while (pending != 0)
+    {
+        int bit = __builtin_ctzll(pending);
+        if (bit < 63 && ((quoted >> bit) & 1)) quoted ^= ~0ULL << (bit + 1);
+        pending &= pending - 1;
+    }
+    inQuotes = ((quoted & ~newlines) >> 63) ? ~0ULL : 0; // State after the last byte of the block (a final newline resets it)
+
+    uint64_t structurals = (commas & ~quoted) | newlines;
+    while (structurals != 0)
+    {
+        offsets.push_back(base + __builtin_ctzll(structurals));
+        structurals &= structurals - 1;
+    }
+}
+
+#ifdef CSV_HAVE_X86
+// SSE2 kernel: four 16-byte compares per 64-byte block
+static void indexSse2(const char* begin, const char* end, MyVector<unsigned>& offsets)
+{
+    const __m128i comma = _mm_set1_epi8(','), quote = _mm_set1_epi8('"'), newline = _mm_set1_epi8('\n');
+    uint64_t inQuotes = 0;
+    size_t length = end - begin, pos = 0;
+    char tail[64];
+
+    while (pos < length)
+    {
+        const char* block = begin + pos;
+        if (length - pos < 64) // Pad the last partial block with bytes that are never structural
+        {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, block, length - pos);
+            block = tail;
+        }
+        uint64_t commas = 0, quotes = 0, newlines = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+            commas |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, comma)) << (16 * i);
+            quotes |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote)) << (16 * i);
+            newlines |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)) << (16 * i);
+        }
+        emitBlock(commas, quotes, newlines, inQuotes, pos, offsets);
+        pos += 64;
+    }
+}
+
+// AVX2 kernel: two 32-byte compares per 64-byte block
+__attribute__((target("avx2")))
+static void indexAvx2(const char* begin, const char* end, MyVector<unsigned>& offsets)
+{
+    const __m256i comma = _mm256_set1_epi8(','), quote = _mm256_set1_epi8('"'), newline = _mm256_set1_epi8('\n');
+    uint64_t inQuotes = 0;
+    size_t length = end - begin, pos = 0;
+    char tail[64];
+
+    while (pos < length)
+    {
+        const char* block = begin + pos;
+        if (length - pos < 64) // Pad the last partial block with bytes that are never structural
+        {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, block, length - pos);
+            block = tail;
+        }
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+        uint64_t commas = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, comma)) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, comma)) << 32);
+        uint64_t quotes = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, quote)) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, quote)) << 32);
+        uint64_t newlines = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newline)) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newline)) << 32);
+        emitBlock(commas, quotes, newlines, inQuotes, pos, offsets);
+        pos += 64;
+    }
+}
+#endif
+
+// Function to pick the fastest kernel supported by the CPU, once
+CsvKernel csvBestKernel()
+{
+#ifdef CSV_HAVE_X86
+    static const CsvKernel best = __builtin_cpu_supports("avx2") ? CSV_AVX2 : CSV_SSE2; // SSE2 is part of x86-64
+    return best;
+#else
+    return CSV_SCALAR;
+#endif
+}
+
+// Function to get the printable name of a kernel
+const char* csvKernelName(CsvKernel kernel)
+{
+    switch (kernel)
+    {
+        case CSV_AVX2: return "avx2";
+        case CSV_SSE2: return "sse2";
+        default:       return "scalar";
+    }
+}
+
+// Function to index the structural characters of a buffer with the requested kernel
+void csvIndex(const char* begin, const char* end, MyVector<unsigned>& offsets, CsvKernel kernel)
+{
+#ifdef CSV_HAVE_X86
+    if (kernel == CSV_AVX2 && csvBestKernel() == CSV_AVX2) { indexAvx2(begin, end, offsets); return; }
+    if (kernel != CSV_SCALAR) { indexSse2(begin, end, offsets); return; }
+#endif
+    indexScalar(begin, end, offsets); // Also the fallback when a kernel is not available
+}
@@ -0,0 +1,50 @@
+//============================================================================
+// Name         : csv.h
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Zero-copy tokenizer for the book CSV format
+//============================================================================
+#ifndef _CSV_H
+#define _CSV_H
+#include<cstddef>
+#include<string>
+#include "myvector.h"
+
+// A field of a record, pointing into the buffer that holds the CSV text
+struct FieldView
+{
+	const char* data;
+	size_t length;
+
+	std::string str() const { return std::string(data, length); }	//copy the field into a string
+	bool equals(const std::string& text) const;						//compare with a string without copying
+	int toInt() const;													//parse the field like stoi, throws invalid_argument/out_of_range
+};
+
+// Maximum number of fields kept per record; longer records are still counted
+const int CSV_MAX_FIELDS = 8;
+
+// Return the end of the line that starts at begin (the '\n' or end)
+const char* csvLineEnd(const char* begin, const char* end);
+
+// Return the field [begin, end) without its surrounding quotes
+FieldView csvField(const char* begin, const char* end);
+
+// Split the line [begin, end) on commas outside quotes and strip surrounding quotes
+// from each field. Stores at most CSV_MAX_FIELDS fields and returns the field count.
+int csvSplit(const char* begin, const char* end, FieldView* fields);
+
+// Implementations of csvIndex; the best one supported by the CPU is picked at runtime
+enum CsvKernel { CSV_SCALAR, CSV_SSE2, CSV_AVX2 };
+
+CsvKernel csvBestKernel();						//fastest kernel the CPU supports
+const char* csvKernelName(CsvKernel kernel);	//printable name of a kernel
+
+// Append the offset (from begin) of every structural character in [begin, end): each
+// newline, and each comma outside quotes. Quote state resets at every newline, so the
+// offsets split the text exactly like csvLineEnd/csvSplit do. The SIMD kernels classify
+// 64 bytes at a time and find quoted regions with a prefix XOR of the quote mask.
+void csvIndex(const char* begin, const char* end, MyVector<unsigned>& offsets, CsvKernel kernel = csvBestKernel());
+#endif
@@ -0,0 +1,115 @@
+//============================================================================
+// Name         : flattree.cpp
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  :
+//============================================================================
+#include "flattree.h" // Include the header file for the FlatTree class
+#include "tree.h"
+using namespace std;
+
+// Constructor: an empty layout that matches no generation of a tree
+FlatTree::FlatTree()
+{
+    builtFor = NEVER;
+}
+
+// Method to lay out the subtree of a node in pre-order; each node learns its id
+void FlatTree::build(Node* root, uint64_t generation)
+{
+    entries.clear(); // The arrays keep their capacity, rebuilds do not allocate
+    books.clear();
+
+    // Depth-first walk with an explicit stack, so a deep tree cannot overflow the call stack
+    struct Pending
+    {
+        Node* node;
+        uint32_t parent;
+    };
+    MyVector<Pending> stack;
+    Pending first = { root, NONE };
+    stack.push_back(first);
+    while (!stack.empty())
+    {
+        Pending next = stack[stack.size() - 1];
+        stack.erase(stack.size() - 1);
+
+        Node* node = next.node;
+        Entry entry = { node, next.parent, 0, static_cast<uint32_t>(books.size()), static_cast<uint32_t>(node->books.size()) };
+        node->flatId = entries.size();
+        entries.push_back(entry);
+        for (int i = 0; i < node->books.size(); ++i)
+        {
+            books.push_back(node->books[i]); // The books of a node are contiguous
+        }
+        for (int i = node->children.size() - 1; i >= 0; --i) // Pushed last to first so the first child is laid out first
+        {
+            Pending child = { node->children[i], node->flatId };
+            stack.push_back(child);
+        }
+    }
+
+    // A subtree ends where the subtree of its last descendant ends; walking backwards, every
+    // node is finished before its parent reads it
+    for (uint32_t id = entries.size(); id-- > 0; )
+    {
+        if (entries[id].subtreeEnd == 0) entries[id].subtreeEnd = id + 1; // A leaf, or not reached by any child yet
+        uint32_t parent = entries[id].parent;
+        if (parent != NONE && entries[parent].subtreeEnd < entries[id].subtreeEnd)
+        {
+            entries[parent].subtreeEnd = entries[id].subtreeEnd;
+        }
+    }
+    builtFor = generation;
+}
+
+// Method to check whether the layout matches a generation of the tree
+bool FlatTree::isCurrent(uint64_t generation) const
+{
+    return builtFor == generation;
+}
+
+// Method to get the number of nodes in the layout
+uint32_t FlatTree::size() const
+{
+    return entries.size();
+}
+
+// Operator to get the node with a given id
+const FlatTree::Entry& FlatTree::operator[](uint32_t id) const
+{
+    return entries[id];
+}
+
+// Method to get the book at a position of the books array
+Book* FlatTree::book(uint32_t index) const
+{
+    return books[index];
+}
+
+// Method to get the first book of the subtree of a node, which is the node's own first book
+uint32_t FlatTree::bookBegin(uint32_t id) const
+{
+    return entries[id].firstBook;
+}
+
+// Method to get one past the last book of the subtree of a node: the first book of the node after it
+uint32_t FlatTree::bookEnd(uint32_t id) const
+{
+    uint32_t end = entries[id].subtreeEnd;
+    return (end < static_cast<uint32_t>(entries.size())) ? entries[end].firstBook : books.size();
+}
+
+// Method to count the books of the subtree of a node
+uint32_t FlatTree::subtreeBooks(uint32_t id) const
+{
+    return bookEnd(id) - bookBegin(id);
+}
+
+// Method to get the memory held by the layout
+size_t FlatTree::bytes() const
+{
+    return entries.capacity() * sizeof(Entry) + books.capacity() * sizeof(Book*);
+}
@@ -0,0 +1,57 @@
+//============================================================================
+// Name         : flattree.h
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Pre-order array layout of the category tree
+//============================================================================
+#ifndef _FLATTREE_H
+#define _FLATTREE_H
+#include<cstddef>
+#include<cstdint>
+#include "myvector.h"
+class Node;
+class Book;
+
+// A FlatTree lays the nodes of a Tree out in one array in pre-order, addressed by 32-bit
+// ids, and the books of every node back to back in a second array in the same order.
+// A subtree is then the id range [id, subtreeEnd) and its books the index range
+// [bookBegin(id), bookEnd(id)), so scanning a subtree is a linear sweep and counting its
+// books is a subtraction. The layout is a copy of the pointer tree's structure: the Tree
+// rebuilds it when its generation moved since the last build (see Tree::layout()).
+class FlatTree
+{
+	public:
+		struct Entry
+		{
+			Node* node;				//the node in the pointer tree
+			uint32_t parent;		//id of the parent, NONE for the root
+			uint32_t subtreeEnd;	//one past the id of the last node of the subtree
+			uint32_t firstBook;		//index of the node's first book in the books array
+			uint32_t ownBooks;		//books of the node itself, its children's follow them
+		};
+		static const uint32_t NONE = 0xffffffff;
+		static const uint64_t NEVER = ~0ULL;	//generation of a layout that was never built
+
+	private:
+		MyVector<Entry> entries;	//nodes in pre-order, the root has id 0
+		MyVector<Book*> books;		//books grouped by node, in the order of entries
+		uint64_t builtFor;			//generation of the tree the layout was built for
+
+		FlatTree(const FlatTree&);	//not copyable, the nodes hold their ids in it
+		FlatTree& operator=(const FlatTree&);
+
+	public:
+		FlatTree();
+		void build(Node* root, uint64_t generation);	//lay out the subtree of root, numbering its nodes
+		bool isCurrent(uint64_t generation) const;		//true if built for this generation of the tree
+		uint32_t size() const;							//number of nodes
+		const Entry& operator[](uint32_t id) const;		//node with a given id
+		Book* book(uint32_t index) const;				//book at a position of the books array
+		uint32_t bookBegin(uint32_t id) const;			//first book of the subtree of a node
+		uint32_t bookEnd(uint32_t id) const;			//one past the last book of the subtree of a node
+		uint32_t subtreeBooks(uint32_t id) const;		//books of the subtree of a node
+		size_t bytes() const;							//memory of the two arrays
+};
+#endif
@@ -0,0 +1,162 @@
+//============================================================================
+// Name         : isbn.cpp
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  :
+//============================================================================
+#include "isbn.h" // Include the header file for the Isbn class
+#include <cctype>
+using namespace std;
+
+StringPool Isbn::verbatim; // Shared by every book of every catalog
+
+// Bit layout of the packed form: digit count in bits 56-59, the 'X' check character in bit 55,
+// the value of the digits (without an 'X') below
+static const int DIGITS_SHIFT = 56;
+static const uint64_t CHECK_X = 1ULL << 55;
+static const uint64_t VALUE_MASK = (1ULL << 55) - 1;
+
+// Helper method to pack a bare ISBN-10 or ISBN-13
+bool Isbn::pack(const string& text, uint64_t& bits)
+{
+    size_t digits = text.size();
+    if (digits != 10 && digits != 13) return false;
+    bool checkX = (digits == 10 && text[9] == 'X'); // Only the check character of an ISBN-10 may be an X
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < digits - (checkX ? 1 : 0); ++i)
+    {
+        if (text[i] < '0' || text[i] > '9') return false;
+        value = value * 10 + (text[i] - '0');
+    }
+    bits = PACKED | (static_cast<uint64_t>(digits) << DIGITS_SHIFT) | (checkX ? CHECK_X : 0) | value;
+    return true;
+}
+
+// Constructor for an empty ISBN
+Isbn::Isbn()
+{
+    bits = reinterpret_cast<uintptr_t>(verbatim.intern(string()));
+}
+
+// Constructor: pack the ISBN if it is bare, intern it as written otherwise
+Isbn::Isbn(const string& text)
+{
+    if (!pack(text, bits))
+    {
+        bits = reinterpret_cast<uintptr_t>(verbatim.intern(text));
+    }
+}
+
+// Method to get the ISBN as it was entered
+string Isbn::str() const
+{
+    string out;
+    appendTo(out);
+    return out;
+}
+
+// Method to append the ISBN as it was entered to a buffer
+void Isbn::appendTo(string& out) const
+{
+    if (!isPacked())
+    {
+        out.append(*text());
+        return;
+    }
+
+    int digits = static_cast<int>((bits >> DIGITS_SHIFT) & 0xf);
+    bool checkX = (bits & CHECK_X) != 0;
+    char buffer[13];
+    buffer[digits - 1] = 'X'; // Overwritten below unless the check character is an X
+    uint64_t value = bits & VALUE_MASK;
+    for (int i = digits - (checkX ? 2 : 1); i >= 0; --i) // Fill in the digits from the last one, leading zeros included
+    {
+        buffer[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    out.append(buffer, digits);
+}
+
+// Method to get the ISBN without hyphens or spaces, with an upper case check character
+string Isbn::normalized() const
+{
+    if (isPacked()) return str(); // Already bare
+
+    string out;
+    const string& written = *text();
+    for (size_t i = 0; i < written.size(); ++i)
+    {
+        if (written[i] == '-' || written[i] == ' ') continue; // Formatting only
+        out.push_back(static_cast<char>(toupper(static_cast<unsigned char>(written[i]))));
+    }
+    return out;
+}
+
+// Helper method to get the ISBN-13 digits of a packed ISBN; an ISBN-10 becomes 978, its first
+// nine digits and the check digit of the ISBN-13, which ignores the ISBN-10's own check character
+bool Isbn::keyOf(uint64_t packed, uint64_t& key)
+{
+    int digits = static_cast<int>((packed >> DIGITS_SHIFT) & 0xf);
+    uint64_t value = packed & VALUE_MASK;
+    if (digits == 13)
+    {
+        key = value;
+        return true;
+    }
+    uint64_t body = (packed & CHECK_X) ? value : value / 10; // The nine digits before the check character
+    uint64_t prefixed = 978000000000ULL + body;
+    int sum = 0;
+    for (int i = 11; i >= 0; --i, prefixed /= 10) // Weights 1 and 3 alternate from the first digit, the last of twelve has 3
+    {
+        sum += static_cast<int>(prefixed % 10) * ((i % 2) ? 3 : 1);
+    }
+    key = (978000000000ULL + body) * 10 + (10 - sum % 10) % 10;
+    return true;
+}
+
+// Method to get the key of the ISBN: the digits of its ISBN-13, whatever form it was entered in
+bool Isbn::key(uint64_t& key) const
+{
+    if (isPacked()) return keyOf(bits, key);
+    return Isbn::key(*text(), key); // Hyphens or spaces: strip them and try again
+}
+
+// Method to get the key of an ISBN typed at a lookup, hyphenated or not
+bool Isbn::key(const string& text, uint64_t& key)
+{
+    string bare;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '-' || text[i] == ' ') continue; // Formatting only
+        bare.push_back(static_cast<char>(toupper(static_cast<unsigned char>(text[i]))));
+    }
+    uint64_t packed;
+    return pack(bare, packed) && keyOf(packed, key);
+}
+
+// Method to check whether the ISBN is held as packed digits
+bool Isbn::isPacked() const
+{
+    return (bits & PACKED) != 0;
+}
+
+// Method to get the interned text of an ISBN that did not pack
+const string* Isbn::text() const
+{
+    return isPacked() ? nullptr : reinterpret_cast<const string*>(static_cast<uintptr_t>(bits));
+}
+
+// Operator to compare two ISBNs as written; equal texts are interned once, so the bits are equal
+bool Isbn::operator==(const Isbn& other) const
+{
+    return bits == other.bits;
+}
+
+// Method to get the pool of ISBNs that do not pack, for memory reports
+StringPool& Isbn::pool()
+{
+    return verbatim;
+}
@@ -0,0 +1,45 @@
+//============================================================================
+// Name         : isbn.h
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : ISBN of a book packed into 64 bits
+//============================================================================
+#ifndef _ISBN_H
+#define _ISBN_H
+#include<cstdint>
+#include<string>
+#include "stringpool.h"
+
+// An Isbn holds a bare ISBN-10 (nine digits and a digit or 'X') or ISBN-13 (thirteen
+// digits) as a number in 64 bits: the top bit marks the packed form, then the number
+// of digits, the 'X' check character and the digits themselves. Anything else (a
+// hyphenated ISBN, an empty or malformed one) is interned as written and the Isbn
+// holds the pool's pointer, so the catalog always prints an ISBN exactly as entered.
+// normalized() strips the formatting of both forms for comparisons, and key() maps an
+// ISBN-10 and the ISBN-13 it became to the same number, for indexing.
+class Isbn
+{
+	private:
+		uint64_t bits;					//packed digits, or the address of the interned text
+
+		static const uint64_t PACKED = 1ULL << 63;	//set for the packed form, user-space pointers never have it
+		static StringPool verbatim;		//ISBNs that do not pack, as they were written
+		static bool pack(const std::string& text, uint64_t& bits);	//pack a bare ISBN-10/13, false if text is not one
+		static bool keyOf(uint64_t packed, uint64_t& key);	//key of a packed ISBN
+
+	public:
+		Isbn();								//empty ISBN
+		explicit Isbn(const std::string& text);
+		std::string str() const;			//the ISBN as it was entered
+		void appendTo(std::string& out) const;	//append the ISBN as it was entered, without a temporary string
+		std::string normalized() const;		//digits and check character only, upper case
+		bool key(uint64_t& key) const;		//the digits of the ISBN-13, false if the ISBN is not an ISBN-10/13 once formatting is stripped
+		static bool key(const std::string& text, uint64_t& key);	//key of an ISBN as typed, for lookups
+		bool isPacked() const;				//true if the digits are held inline
+		const std::string* text() const;	//the interned text of an ISBN that does not pack, nullptr otherwise
+		bool operator==(const Isbn& other) const;	//same ISBN as written
+		static StringPool& pool();			//ISBNs that do not pack
+};
+#endif
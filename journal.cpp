@@ -0,0 +1,249 @@
+//============================================================================
+// Name         : journal.cpp
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : 
+//============================================================================
+#include "journal.h" // Include the header file for the Journal class
+#include "mappedfile.h"
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+static const size_t JOURNAL_FRAME_BYTES = 16;	// length, checksum and sequence ahead of op and payload
+
+// Constructor: start an empty record for an operation
+JournalRecord::JournalRecord(uint8_t op) : op(op), sequence(0), cursor(0)
+{
+}
+
+// Method to append a string argument, prefixed with its length
+JournalRecord& JournalRecord::put(const string& text)
+{
+    put(static_cast<int32_t>(text.size()));
+    payload.append(text);
+    return *this;
+}
+
+// Method to append an integer argument in native byte order
+JournalRecord& JournalRecord::put(int32_t number)
+{
+    payload.append(reinterpret_cast<const char*>(&number), sizeof(number));
+    return *this;
+}
+
+// Method to read the next integer argument
+int32_t JournalRecord::getInt()
+{
+    int32_t number;
+    if (payload.size() - cursor < sizeof(number))
+    {
+        throw runtime_error("Invalid journal record " + to_string(sequence));
+    }
+    memcpy(&number, payload.data() + cursor, sizeof(number));
+    cursor += sizeof(number);
+    return number;
+}
+
+// Method to read the next string argument
+string JournalRecord::getString()
+{
+    int32_t length = getInt();
+    if (length < 0 || payload.size() - cursor < (size_t)length)
+    {
+        throw runtime_error("Invalid journal record " + to_string(sequence));
+    }
+    string text = payload.substr(cursor, length);
+    cursor += length;
+    return text;
+}
+
+// Method to get the operation of the record
+uint8_t JournalRecord::getOp() const
+{
+    return op;
+}
+
+// Method to get the position of the record in the journal
+uint64_t JournalRecord::getSequence() const
+{
+    return sequence;
+}
+
+// Helper function: 32-bit FNV-1a, enough to tell a torn or overwritten frame from a whole one
+static uint32_t journalChecksum(const char* data, size_t length, uint32_t hash = 2166136261u)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+// Constructor: open the journal for appending and start the flusher thread
+Journal::Journal(const string& path, uint64_t nextSequence) : path(path)
+{
+    this->fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (this->fd < 0)
+    {
+        throw runtime_error("Couldn't open the journal " + path);
+    }
+    this->nextSequence = nextSequence;
+    this->queuedSequence = nextSequence - 1;
+    this->durableSequence = nextSequence - 1;
+    this->syncCount = 0;
+    this->failed = false;
+    this->stopping = false;
+    this->flusher = thread(&Journal::flushLoop, this);
+}
+
+// Destructor: the flusher writes whatever is still queued before it stops
+Journal::~Journal()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    pendingReady.notify_one();
+    flusher.join();
+    close(fd);
+}
+
+// Method to frame a record and queue it for the flusher
+uint64_t Journal::append(JournalRecord& record)
+{
+    lock_guard<mutex> guard(lock);
+    record.sequence = nextSequence++;
+
+    uint32_t length = 1 + record.payload.size();
+    char frame[JOURNAL_FRAME_BYTES + 1];
+    memcpy(frame + 8, &record.sequence, sizeof(record.sequence));
+    frame[JOURNAL_FRAME_BYTES] = static_cast<char>(record.op);
+    uint32_t checksum = journalChecksum(frame + 8, 9); // Sequence and op
+    checksum = journalChecksum(record.payload.data(), record.payload.size(), checksum);
+    memcpy(frame, &length, sizeof(length));
+    memcpy(frame + 4, &checksum, sizeof(checksum));
+
+    pending.append(frame, sizeof(frame));
+    pending.append(record.payload);
+    queuedSequence = record.sequence;
+    pendingReady.notify_one();
+    return record.sequence;
+}
+
+// Method to wait until a record, and every record before it, is on stable storage
+void Journal::commit(uint64_t sequence)
+{
+    unique_lock<mutex> guard(lock);
+    synced.wait(guard, [this, sequence] { return durableSequence >= sequence || failed; });
+    if (durableSequence < sequence)
+    {
+        throw runtime_error("Couldn't write the journal " + path);
+    }
+}
+
+// Body of the flusher thread: write and sync everything queued, one batch at a time
+void Journal::flushLoop()
+{
+    string batch; // Records being written; appends go to pending meanwhile
+    unique_lock<mutex> guard(lock);
+    while (true)
+    {
+        pendingReady.wait(guard, [this] { return !pending.empty() || stopping; });
+        if (pending.empty()) break; // Stopping with nothing left to write
+
+        batch.swap(pending);
+        uint64_t batchEnd = queuedSequence;
+        guard.unlock(); // Appenders keep queuing while this batch is written
+
+        bool ok = true;
+        for (size_t written = 0; ok && written < batch.size(); )
+        {
+            ssize_t n = write(fd, batch.data() + written, batch.size() - written);
+            if (n < 0) ok = false;
+            else written += n;
+        }
+        ok = ok && fdatasync(fd) == 0;
+        batch.clear();
+
+        guard.lock();
+        syncCount++;
+        if (ok && !failed) durableSequence = batchEnd;
+        else failed = true; // A lost batch leaves a gap, so nothing after it can be durable
+        synced.notify_all();
+    }
+}
+
+// Method to empty the journal once a checkpoint holds everything in it
+void Journal::reset()
+{
+    commit(lastSequence()); // Nothing may be in flight while the file is cut
+    lock_guard<mutex> guard(lock);
+    if (ftruncate(fd, 0) != 0 || fdatasync(fd) != 0)
+    {
+        throw runtime_error("Couldn't truncate the journal " + path);
+    }
+}
+
+// Method to get the sequence of the last record appended
+uint64_t Journal::lastSequence()
+{
+    lock_guard<mutex> guard(lock);
+    return nextSequence - 1;
+}
+
+// Method to get the number of syncs so far
+uint64_t Journal::syncs()
+{
+    lock_guard<mutex> guard(lock);
+    return syncCount;
+}
+
+// Method to replay the intact records of a journal file in order
+uint64_t Journal::replay(const string& path, uint64_t after, const function<void(JournalRecord&)>& apply)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+    {
+        return after; // No journal yet
+    }
+
+    uint64_t last = after;
+    size_t valid = 0; // Bytes of whole records
+    {
+        MappedFile file(path);
+        const char* data = file.data();
+        while (file.size() - valid >= JOURNAL_FRAME_BYTES + 1)
+        {
+            uint32_t length, checksum;
+            uint64_t sequence;
+            memcpy(&length, data + valid, sizeof(length));
+            memcpy(&checksum, data + valid + 4, sizeof(checksum));
+            memcpy(&sequence, data + valid + 8, sizeof(sequence));
+            if (length == 0 || length > file.size() - valid - JOURNAL_FRAME_BYTES) break; // Torn length or payload
+            if (journalChecksum(data + valid + 8, 8 + length) != checksum) break; // Torn or garbled frame
+
+            if (sequence > after)
+            {
+                JournalRecord record(static_cast<uint8_t>(data[valid + JOURNAL_FRAME_BYTES]));
+                record.sequence = sequence;
+                record.payload.assign(data + valid + JOURNAL_FRAME_BYTES + 1, length - 1);
+                apply(record);
+                last = sequence;
+            }
+            valid += JOURNAL_FRAME_BYTES + length;
+        }
+        if (valid == file.size()) return last;
+    }
+
+    if (truncate(path.c_str(), valid) != 0) // Drop the torn tail so new records follow whole ones
+    {
+        throw runtime_error("Couldn't truncate the journal " + path);
+    }
+    return last;
+}
@@ -0,0 +1,99 @@
+//============================================================================
+// Name         : journal.h
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Append-only write-ahead journal with group commit
+//============================================================================
+#ifndef _JOURNAL_H
+#define _JOURNAL_H
+#include<string>
+#include<stdint.h>
+#include<functional>
+#include<mutex>
+#include<condition_variable>
+#include<thread>
+using namespace std;
+
+// Operations recorded in the journal. Books are named by the path of their category and
+// their position in it, which survives a snapshot, unlike the order of the title index.
+enum JournalOp
+{
+	JOURNAL_ADD_BOOK = 1,		//category, title, author, isbn, year, total copies, available copies
+	JOURNAL_EDIT_BOOK,			//category, position, field, value
+	JOURNAL_REMOVE_BOOK,		//category, position
+	JOURNAL_BORROW,				//category, position, borrower name, borrower id
+	JOURNAL_RETURN,				//category, position, borrower name, borrower id
+	JOURNAL_ADD_CATEGORY,		//category
+	JOURNAL_REMOVE_CATEGORY,	//category
+	JOURNAL_RENAME_CATEGORY		//category, new name
+};
+
+// One journal record: an operation and its arguments, packed as length-prefixed strings
+// and 32-bit integers in the order listed above
+class JournalRecord
+{
+	private:
+		uint8_t op;
+		uint64_t sequence;		//position of the record in the journal, set by append or replay
+		string payload;			//packed arguments
+		size_t cursor;			//read position in payload
+
+		friend class Journal;
+
+	public:
+		JournalRecord(uint8_t op);
+		JournalRecord& put(const string& text);	//append a string argument
+		JournalRecord& put(int32_t number);		//append an integer argument
+		string getString();						//read the next string argument, throws at the end of the record
+		int32_t getInt();						//read the next integer argument, throws at the end of the record
+		uint8_t getOp() const;
+		uint64_t getSequence() const;
+};
+
+// On disk every record is framed as
+//   u32 length | u32 checksum | u64 sequence | u8 op | payload
+// where length counts op and payload and the checksum covers sequence, op and payload.
+// A crash can only tear the last record; replay stops at the first frame that does not
+// check out and the journal is truncated there before new records are appended.
+//
+// append() only queues a record. A flusher thread writes everything queued and syncs it
+// with a single fdatasync, and commit() waits for the sync that covers a record, so all
+// the records queued while one sync is in flight share the next one (group commit).
+class Journal
+{
+	private:
+		string path;
+		int fd;							//journal file, opened for appending
+		mutex lock;						//guards everything below
+		condition_variable pendingReady;	//wakes the flusher
+		condition_variable synced;			//wakes committers
+		string pending;					//framed records not yet written
+		uint64_t nextSequence;			//sequence of the next record appended
+		uint64_t queuedSequence;		//last record in pending or written
+		uint64_t durableSequence;		//last record on stable storage
+		uint64_t syncCount;				//number of fdatasync calls, for statistics
+		bool failed;					//a write or sync failed, nothing more is durable
+		bool stopping;
+		thread flusher;
+
+		Journal(const Journal&);				//not copyable, the file has a single writer
+		Journal& operator=(const Journal&);
+		void flushLoop();				//body of the flusher thread
+
+	public:
+		Journal(const string& path, uint64_t nextSequence);	//open for appending, throws runtime_error on failure
+		~Journal();						//flush what is queued and stop the flusher
+
+		uint64_t append(JournalRecord& record);	//queue a record and return its sequence
+		void commit(uint64_t sequence);			//wait until a record is durable, throws runtime_error if the journal failed
+		void reset();							//empty the journal after a checkpoint, keeping the sequence
+		uint64_t lastSequence();				//sequence of the last record appended
+		uint64_t syncs();						//number of syncs so far
+
+		// Call apply for every intact record with a sequence above after, in order, and
+		// truncate a torn tail. Returns the last sequence found, or after if there is none.
+		static uint64_t replay(const string& path, uint64_t after, const function<void(JournalRecord&)>& apply);
+};
+#endif
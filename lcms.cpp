@@ -7,124 +7,265 @@
 // Description  : 
 //============================================================================
 #include <fstream> 
+#include <limits>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
 #include <iostream> 
 #include "lcms.h" 
+#include "csv.h"
+#include "mappedfile.h"
+#include "snapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
 using namespace std; 
 
 // Constructor for the LCMS class, initializes a new library tree with a given name
 LCMS :: LCMS(string name)
 {
 	this->libTree = new Tree(name); // Allocate memory for a new Tree object and assign it to libTree
+	this->workerThreads = thread::hardware_concurrency(); // Use every core by default
+	if (this->workerThreads < 1) this->workerThreads = 1; // hardware_concurrency may not know the core count
+	this->view = nullptr; // Start with an empty in-memory catalog
+	this->journal = nullptr; // Changes are not journaled until openJournal
 }
 
 // Destructor for the LCMS class, cleans up allocated memory
 LCMS :: ~LCMS()
 {
 	delete this->libTree; // Deallocate memory for the library tree
-
-	for(int i = 0 ; i < this->borrowers.size(); i ++) // Loop through the vector of borrowers
-	{
-		delete this->borrowers[i]; // Deallocate memory for each borrower in the vector
-	}
+	delete this->view; // Unmap the read-only snapshot, if any
+	delete this->journal; // Flush the journal
+	// The borrower pool frees every borrower with its slabs
 }
 
-// Method to import books from a CSV file into the library system
-int LCMS::import(string path) {
-    ifstream infile(path); // Open the file at the given path for reading
-    if (infile.fail()) { // Check if the file failed to open
-        throw runtime_error("Couldn't open the file"); // Throw an exception if the file cannot be opened
+// A line parsed by an import worker, applied to the catalog later in file order
+struct ImportRow
+{
+    const char* line;		// start of the line in the mapping
+    const char* lineEnd;	// end of the line (the '\n' or end of file)
+    FieldView category;		// category path of the record
+    Book* book;				// book built from the record, nullptr for a malformed line
+    exception_ptr error;	// number parsing failure, rethrown when the row is applied
+};
+
+// What one import worker builds books from: pools and arenas are not thread-safe
+struct ImportStore
+{
+    Pool<Book> books;		// the worker's books
+    TextArena titles;		// their titles
+
+    // Free a book that will not be added to the catalog
+    void discard(Book* book)
+    {
+        if (book == nullptr) return;
+        titles.release(book->getTitle());
+        books.destroy(book);
     }
+};
 
-    string line; // String to hold each line read from the file
-    getline(infile, line); // Read and discard the header line
-    int num_import = 0; // Counter for the number of records successfully imported
+// Size of the slice of the file one worker parses per round
+static const size_t IMPORT_CHUNK_BYTES = 4 << 20;
 
-    while (getline(infile, line)) { // Read each line until the end of the file
-        MyVector<string> book_data; // Vector to hold the split fields of each book record
-        string field; // String to hold each field value
-        bool inQuotes = false; // Flag to track whether the current character is within quotes
-        int startField = 0; // Index to mark the start of a field
-
-        // Loop over each character in the line to split it into fields
-        for (int i = 0; i <= line.size(); ++i) {
-            // Check for end of line or comma outside quotes, marking the end of a field
-            if (i == line.size() || (line[i] == ',' && !inQuotes)) {
-                field = line.substr(startField, i - startField); // Extract the field
-                if (!field.empty() && field.front() == '"' && field.back() == '"') { // Remove surrounding quotes
-                    field = field.substr(1, field.size() - 2);
-                }
-                book_data.push_back(field); // Add the field to the book_data vector
-                startField = i + 1; // Set the start of the next field
-            } else if (line[i] == '"') { // Toggle the inQuotes flag on encountering a quote
-                inQuotes = !inQuotes;
-            }
-        }
+// Number of titles fuzzyFind suggests at most
+static const int FUZZY_RESULTS = 10;
 
-        // Process the book record if it has the correct number of fields
-        if (book_data.size() == 7) {
-            // Extract book information from the vector
-            string title = book_data[0];
-            string author = book_data[1];
-            string isbn = book_data[2];
-            int publn_year = stoi(book_data[3]);
-            string category = book_data[4];
-            int total_copies = stoi(book_data[5]);
-            int available_copies = stoi(book_data[6]);
-
-            // Create or find the category node and add the book to it if it doesn't already exist
-            Node* temp = libTree->createNode(category);
-            bool found = false; // Flag to indicate if the book was found in the category
-            for (int i = 0; i < temp->books.size() && !found; ++i) {
-                if (temp->books[i]->title == title) {
-                    found = true; // Set flag if book exists
-                }
-            }
-            if (!found) { // If book doesn't exist, add it
-                temp->books.push_back(new Book(title, author, isbn, publn_year, total_copies, available_copies));
-                // Increment the book count for the category and its ancestors
-                Node* toUpdate = temp;
-                while (toUpdate) {
-                    toUpdate->bookCount += 1;
-                    toUpdate = toUpdate->parent;
-                }
-                num_import++; // Increment the import counter
+// Turn one record into a row; the fields come from the structural index of the chunk
+static ImportRow parseRecord(const char* line, const char* lineEnd, FieldView* book_data, int fieldCount, ImportStore* store)
+{
+    ImportRow row;
+    row.line = line;
+    row.lineEnd = lineEnd;
+    row.category.data = nullptr;
+    row.category.length = 0;
+    row.book = nullptr;
+
+    if (fieldCount == 7) // Only records with all seven fields become books
+    {
+        try
+        {
+            int publn_year = book_data[3].toInt();
+            int total_copies = book_data[5].toInt();
+            int available_copies = book_data[6].toInt();
+            if (publn_year < numeric_limits<int16_t>::min() || publn_year > numeric_limits<int16_t>::max()) {
+                return row; // A year a book cannot hold makes the line malformed, it is skipped rather than ending the import
             }
-        } else { // If the book record is malformed, skip it and print an error
-            cerr << "Skipping malformed line: " << line << endl;
+            row.category = book_data[4];
+            row.book = store->books.create(store->titles, book_data[0].str(), book_data[1].str(), book_data[2].str(), publn_year, total_copies, available_copies);
+        }
+        catch (...)
+        {
+            row.error = current_exception(); // Keep the error so it surfaces at the same row as a serial import
         }
     }
-
-    infile.close(); // Close the file stream
-    cout << num_import << " records have been imported" << endl; // Print the number of imported records
-    return num_import; // Return the count of imported records
+    return row;
 }
 
-// Recursive helper function to export book data to a file
-int LCMS :: export_helper(Node* node, ofstream& file)
+// Parse every line of [begin, end) into rows; runs on a worker thread and never touches the catalog,
+// the books come from a pool and an arena of the worker's own
+static void parseChunk(const char* begin, const char* end, MyVector<ImportRow>* rows, ImportStore* store)
 {
-    if (node == nullptr) // Base case: node is null
+    MyVector<unsigned> separators; // Offsets of newlines and unquoted commas, found 64 bytes at a time
+    csvIndex(begin, end, separators);
+
+    FieldView book_data[CSV_MAX_FIELDS]; // Fields of the current record, reused for every line
+    int fieldCount = 0;
+    const char* line = begin; // Start of the current record
+    const char* field = begin; // Start of the current field
+    for (int i = 0; i < separators.size(); ++i)
     {
-        return 0;
+        const char* separator = begin + separators[i];
+        if (fieldCount < CSV_MAX_FIELDS) book_data[fieldCount] = csvField(field, separator);
+        fieldCount++;
+        field = separator + 1;
+        if (*separator == '\n') // End of the record
+        {
+            rows->push_back(parseRecord(line, separator, book_data, fieldCount, store));
+            line = field;
+            fieldCount = 0;
+        }
     }
-    if(node->children.size() == 0) // If the node has no children, it's a leaf node
+    if (line < end) // The last line of the file may have no newline
     {
-        return libTree->exportData(node, file); // Export the node's data
+        if (fieldCount < CSV_MAX_FIELDS) book_data[fieldCount] = csvField(field, end);
+        rows->push_back(parseRecord(line, end, book_data, fieldCount + 1, store));
     }
+}
 
-    int sum = libTree->exportData(node, file); // Export the current node's data and get the count
+// Free the books of rows that will never be applied because the import stopped early
+static void discardRows(MyVector<ImportRow>* batches, ImportStore* stores, int batchCount, int firstBatch, int firstRow)
+{
+    for (int b = firstBatch; b < batchCount; ++b)
+    {
+        for (int i = (b == firstBatch) ? firstRow : 0; i < batches[b].size(); ++i)
+        {
+            stores[b].discard(batches[b][i].book);
+        }
+    }
+}
 
-    // Recursively call export_helper for each child and add their counts to the sum
-    for (int i = 0; i < node->children.size(); ++i)
+// Round guard: the books the workers built move to the tree's pool and their titles to its arena
+// when a round ends, also when a row aborts the import; the slabs and chunks change hands, the
+// books and titles stay where they are
+struct AdoptBooks
+{
+    Tree* tree;
+    ImportStore* stores;
+    int count;
+    AdoptBooks(Tree* tree, ImportStore* stores, int count) : tree(tree), stores(stores), count(count) {}
+    ~AdoptBooks()
     {
-        sum += export_helper(node->children[i], file);
+        for (int i = 0; i < count; ++i)
+        {
+            tree->getBookPool().merge(stores[i].books);
+            tree->getTitleArena().merge(stores[i].titles);
+        }
+    }
+};
+
+// Bulk-load guard: rows skip the per-book walk up the ancestors and the counts are rebuilt in one
+// bottom-up pass when the guard goes out of scope, also when an import stops at a malformed row
+struct BulkLoad
+{
+    Tree* tree;
+    BulkLoad(Tree* tree) : tree(tree) {}
+    ~BulkLoad() { tree->recountBooks(); }
+};
+
+// Method to import books from a CSV file into the library system
+int LCMS::import(string path) {
+    ensureWritable(); // The command needs the catalog in memory
+    MappedFile file(path); // Map the whole file; fields are tokenized as views into the mapping
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+
+    const char* cursor = file.data(); // Start of the unparsed part of the file
+    const char* end = cursor + file.size(); // End of the mapped file
+    if (cursor != nullptr) cursor = csvLineEnd(cursor, end) + 1; // Skip the header line
+
+    int num_import = 0; // Counter for the number of records successfully imported
+    int num_rows = 0; // Counter for the number of lines read
+    string category; // Category of the current record, its buffer is reused across lines
+
+    BulkLoad bulk(libTree); // Book counts are recomputed once when the import ends, even if a row aborts it
+    uint64_t lastRecord = 0; // Last journal record of the import
+    while (cursor != nullptr && cursor < end) {
+        // Cut the next round of chunks at line boundaries; a record never spans lines, so a newline
+        // always ends a record even inside an unbalanced quote, exactly like the serial reader
+        MyVector<const char*> cuts;
+        cuts.push_back(cursor);
+        while (cuts.size() <= workerThreads && cursor < end) {
+            const char* next = (size_t)(end - cursor) > IMPORT_CHUNK_BYTES ? cursor + IMPORT_CHUNK_BYTES : end;
+            if (next < end) next = csvLineEnd(next, end) + 1; // Extend the chunk to the end of its last line
+            cursor = (next < end) ? next : end;
+            cuts.push_back(cursor);
+        }
+        int chunkCount = cuts.size() - 1;
+        unique_ptr<MyVector<ImportRow>[]> batches(new MyVector<ImportRow>[chunkCount]); // Rows of one round, freed after it
+        unique_ptr<ImportStore[]> stores(new ImportStore[chunkCount]); // One pool and arena per worker, they are not thread-safe
+        AdoptBooks adopt(libTree, stores.get(), chunkCount);
+
+        // Parse the chunks in parallel; the calling thread takes the first one
+        vector<thread> workers;
+        for (int t = 1; t < chunkCount; ++t) {
+            workers.push_back(thread(parseChunk, cuts[t], cuts[t + 1], &batches[t], &stores[t]));
+        }
+        parseChunk(cuts[0], cuts[1], &batches[0], &stores[0]);
+        for (size_t t = 0; t < workers.size(); ++t) {
+            workers[t].join();
+        }
+
+        // Apply the parsed rows in file order so the catalog matches a serial import exactly
+        for (int b = 0; b < chunkCount; ++b) {
+            for (int i = 0; i < batches[b].size(); ++i) {
+                ImportRow& row = batches[b][i];
+                num_rows++;
+                if (row.error) { // A malformed number aborts the import at this row, as stoi did
+                    discardRows(batches.get(), stores.get(), chunkCount, b, i + 1);
+                    journalCommit(lastRecord); // The rows before it stay imported
+                    rethrow_exception(row.error);
+                }
+                if (row.book == nullptr) { // If the book record is malformed, skip it and print an error
+                    cerr << "Skipping malformed line: ";
+                    cerr.write(row.line, row.lineEnd - row.line) << endl;
+                    continue;
+                }
+
+                // Create or find the category node and add the book to it if it doesn't already exist
+                category.assign(row.category.data, row.category.length);
+                Node* temp = libTree->createNode(category);
+                if (findInCategory(temp, TextArena::ref(row.book->title)) != nullptr) { // Duplicate title in this category, the first one wins
+                    stores[b].discard(row.book);
+                    continue;
+                }
+                libTree->addBook(temp, row.book); // Also links the book to its category
+                indexBook(row.book); // Make the book reachable through the title index
+                indexGroups(row.book);
+                if (journal != nullptr) {
+                    JournalRecord record = addRecord(category, row.book);
+                    lastRecord = journal->append(record); // Queued only, the whole import shares the syncs
+                }
+                num_import++; // Increment the import counter; book counts are recomputed once at the end
+            }
+        }
     }
-    return sum; // Return the total count of exported records
 
+    journalCommit(lastRecord); // Durable before it is acknowledged
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << num_import << " records have been imported" << endl; // Print the number of imported records
+    cout << num_rows << " rows parsed in " << seconds << " s (" << (seconds > 0 ? static_cast<long long>(num_rows / seconds) : 0) << " rows/s)" << endl;
+    return num_import; // Return the count of imported records
 }
 
 // Method to export all books to a given file
 void LCMS :: exportData(string path)
 {
+    ensureWritable(); // The command needs the catalog in memory
     ofstream outfile(path); // Open the file at the given path for writing
 
     if (outfile.fail()) // Check if the file failed to open
@@ -135,7 +276,7 @@ void LCMS :: exportData(string path)
     {
         // Write the CSV header
         outfile << "Title" << "," << "Author" << "," << "ISBN" << "," << "Publication Year" << "," << "Total Copies" << "," << "Available Copies" << endl;
-        int count = export_helper(libTree->getRoot(), outfile); // Export the data starting from the root
+        int count = libTree->exportData(libTree->getRoot(), outfile, workerThreads); // Export the data in one sweep over the tree, on every worker thread
         std::cout << count << " records have been successfully exported to " << path << std::endl; // Print the export summary
 
         outfile.close(); // Close the file stream
@@ -145,6 +286,7 @@ void LCMS :: exportData(string path)
 // Method to display all books of a specific category
 void LCMS :: findAll(string category)
 {
+    if (view != nullptr) { view->findAll(category); return; } // Answer from the mapped snapshot
     Node* node = libTree->getNode(category); // Find the node for the given category
 
     if (node == nullptr) // If the category does not exist
@@ -153,49 +295,253 @@ void LCMS :: findAll(string category)
     }
     else
     {
-        libTree->printAll(node); // Print all books in the category
+        libTree->printAll(node, workerThreads); // Print all books in the category
         cout << node->bookCount << " records found" << endl; // Print the count of found records
     }
 }
 
-// Helper function to find a book in the library tree
-Book* LCMS::find_book_helper(Node* node, Tree* tree, const string& title) {
-    if (node == nullptr) return nullptr; // If the node is null, return nullptr indicating the book is not found
+// Helper function to find a book by title through the title index; a title shelved in several
+// categories resolves to the copy met first in pre-order, as a walk of the tree would find it
+Book* LCMS::lookupBook(const string& title)
+{
+    unordered_map<TextRef, TitleBucket, TextRefHash>::iterator it = titleIndex.find(TextArena::ref(title)); // Probe the index for the title, without copying it
+    if (it == titleIndex.end() || it->second.empty())
+    {
+        return nullptr; // No book carries this title
+    }
+
+    TitleBucket& bucket = it->second;
+    if (bucket.size() == 1) return bucket[0]; // Most titles are in one category
+    Book* first = bucket[0];
+    for (int i = 1; i < bucket.size(); ++i)
+    {
+        // Compared through the ancestors, a relayout after every change would walk the whole tree
+        if (libTree->precedes(bucket[i]->node, first->node)) first = bucket[i];
+    }
+    return first;
+}
+
+// Helper function to find the book with a given title in one category, through the title index
+Book* LCMS::findInCategory(Node* node, const TextRef& title)
+{
+    unordered_map<TextRef, TitleBucket, TextRefHash>::iterator it = titleIndex.find(title);
+    if (it == titleIndex.end()) return nullptr; // No book carries this title
 
-    // Try to find the book in the current node if it's a leaf node
-    if (node->children.size() == 0)
+    TitleBucket& bucket = it->second; // One entry per category holding the title
+    for (int i = 0; i < bucket.size(); ++i)
     {
-        Book* foundBook = tree->findBook(node, title); // Search for the book in the current node
-        if (foundBook != nullptr) 
+        if (bucket[i]->node == node) return bucket[i];
+    }
+    return nullptr;
+}
+
+// Helper function to register a book in the title and text indices
+void LCMS::indexBook(Book* book)
+{
+    titleIndex[TextArena::ref(book->title)].push_back(book); // Append the book to the bucket of its title; the key views the arena, which outlives the index entry
+    textIndex.add(book); // Index the words of its title and author
+}
+
+// Helper function to register a book under the key of its ISBN; ISBNs that are not ISBN-10/13 are not indexed
+void LCMS::indexIsbn(Book* book)
+{
+    uint64_t key;
+    if (book->isbn.key(key)) isbnIndex[key].push_back(book);
+}
+
+// Helper function to remove a book from the ISBN index
+void LCMS::unindexIsbn(Book* book)
+{
+    uint64_t key;
+    if (book->isbn.key(key)) leaveGroup(isbnIndex, key, book); // Books without a key were never indexed
+}
+
+// Helper function to remove a book from its group in the ISBN, author or year index; the group is
+// searched from the back, where the books added last are, and the hole is filled with its last book
+template <typename Index, typename Key>
+void LCMS::leaveGroup(Index& index, const Key& key, Book* book)
+{
+    typename Index::iterator it = index.find(key);
+    if (it == index.end()) return;
+    typename Index::mapped_type& group = it->second;
+    for (int i = group.size() - 1; i >= 0; --i)
+    {
+        if (group[i] == book)
         {
-            return foundBook; // If found, return the book
+            group[i] = group[group.size() - 1]; // The queries sort what they find, the order of a group does not matter
+            group.erase(group.size() - 1); // Erasing the last book moves nothing
+            break;
         }
-        return nullptr;    // If not found, return nullptr
     }
+    if (group.empty()) index.erase(it); // Drop empty groups, findByYear walks every year of a range
+}
 
-    // If the node is not a leaf node, first check in the current node
-    Book* foundBook = tree->findBook(node, title);
-    if (foundBook != nullptr) 
+// Helper function to remove the books of a subtree from the groups of the ISBN, author or year index
+// they are in, given the keys of the books; each of those groups is filtered once, keeping the books
+// whose node lies outside the subtree, the id range [begin, end) of the current flat layout
+template <typename Index, typename Key>
+void LCMS::leaveGroups(Index& index, MyVector<Key>& keys, uint32_t begin, uint32_t end)
+{
+    sort(keys.begin(), keys.end(), less<Key>());
+    for (int k = 0; k < keys.size(); ++k)
     {
-        return foundBook; // If found, return the book
+        if (k > 0 && keys[k] == keys[k - 1]) continue; // The group was filtered already
+        typename Index::iterator it = index.find(keys[k]);
+        if (it == index.end()) continue;
+        typename Index::mapped_type& group = it->second;
+        int kept = 0;
+        for (int i = 0; i < group.size(); ++i)
+        {
+            uint32_t id = group[i]->node->flatId;
+            if (id < begin || id >= end) group[kept++] = group[i]; // Keep the books of other categories
+        }
+        while (group.size() > kept) group.erase(group.size() - 1);
+        if (group.empty()) index.erase(it);
     }
+}
+
+// Helper function to register a book under its interned author
+void LCMS::indexAuthor(Book* book)
+{
+    authorIndex[book->author].push_back(book);
+}
+
+// Helper function to remove a book from the author index; the pool keeps the author's string
+void LCMS::unindexAuthor(Book* book)
+{
+    leaveGroup(authorIndex, book->author, book);
+}
 
-    // If the book is not found in the current node, search in the children nodes
-    for (int i = 0; i < node->children.size(); ++i) {
-        foundBook = find_book_helper(node->children[i], tree, title); // Recursively search in each child
-        if (foundBook != nullptr) {
-            return foundBook; // If found in a child, return the book
+// Helper function to register a book under its publication year
+void LCMS::indexYear(Book* book)
+{
+    yearIndex[book->publication_year].push_back(book);
+}
+
+// Helper function to remove a book from the year index
+void LCMS::unindexYear(Book* book)
+{
+    leaveGroup(yearIndex, static_cast<int>(book->publication_year), book);
+}
+
+// Helper function to register a book in the ISBN, author and year indices; they are kept apart from
+// indexBook, which editBook calls for a new title, so that removeCategory can filter each group once
+void LCMS::indexGroups(Book* book)
+{
+    indexIsbn(book);
+    indexAuthor(book);
+    indexYear(book);
+}
+
+// Helper function to remove a book from the ISBN, author and year indices
+void LCMS::unindexGroups(Book* book)
+{
+    unindexIsbn(book);
+    unindexAuthor(book);
+    unindexYear(book);
+}
+
+// Helper function to remove a book from the title and text indices
+void LCMS::unindexBook(Book* book)
+{
+    textIndex.remove(book);
+    unordered_map<TextRef, TitleBucket, TextRefHash>::iterator it = titleIndex.find(TextArena::ref(book->title));
+    if (it == titleIndex.end()) return; // The book was never indexed
+
+    TitleBucket& bucket = it->second;
+    for (int i = 0; i < bucket.size(); ++i) // Buckets only grow past one entry for titles shared across categories
+    {
+        if (bucket[i] == book)
+        {
+            bucket.erase(i); // Keep the remaining books in insertion order
+            break;
         }
     }
+    if (bucket.empty())
+    {
+        titleIndex.erase(it); // Drop empty buckets so the index does not keep stale titles
+    }
+}
 
-    // If the book is not found in the current node or any children, return nullptr
-    return nullptr;
+// Helper function to order books by title, and books sharing a title by category path
+bool LCMS::titleOrder(Book* a, Book* b)
+{
+    int order = strcmp(a->title, b->title);
+    if (order != 0) return order < 0;
+    return a->node->cachedPath() < b->node->cachedPath(); // The same title in two categories
+}
+
+// Helper function to forget a book that is about to be removed from the catalog
+void LCMS::dropBook(Book* book)
+{
+    unindexGroups(book);
+    unindexBook(book); // Drop the book from the title index
+    loans.removeBook(book); // Close any loan still open on the book so no borrower points at freed memory
+}
+
+// Helper function to forget all books of a node and its children, one range of the flat layout
+void LCMS::dropSubtree(Node* node)
+{
+    const FlatTree& flat = libTree->layout();
+    uint32_t id = node->flatId, begin = flat.bookBegin(id), end = flat.bookEnd(id);
+    // A group can hold thousands of books (a shared ISBN, a prolific author, a year), so the groups
+    // the subtree's books are in are filtered once each rather than searched once per book
+    MyVector<uint64_t> isbns;
+    MyVector<const string*> authors;
+    MyVector<int> years;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        Book* book = flat.book(i);
+        uint64_t key;
+        if (book->isbn.key(key)) isbns.push_back(key);
+        authors.push_back(book->author);
+        years.push_back(book->publication_year);
+    }
+    leaveGroups(isbnIndex, isbns, id, flat[id].subtreeEnd);
+    leaveGroups(authorIndex, authors, id, flat[id].subtreeEnd);
+    leaveGroups(yearIndex, years, id, flat[id].subtreeEnd);
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        Book* book = flat.book(i);
+        unindexBook(book); // Forget every book of the subtree
+        loans.removeBook(book);
+    }
+}
+
+// Helper function to build the registry key of a borrower; '\0' cannot appear in console input
+static string borrowerKey(const string& name, const string& id)
+{
+    string key;
+    key.reserve(name.size() + id.size() + 1);
+    key.append(name).push_back('\0');
+    key.append(id);
+    return key;
+}
+
+// Helper function to find a registered borrower by name and id
+Borrower* LCMS::findBorrower(const string& name, const string& id)
+{
+    unordered_map<string, Borrower*>::iterator it = borrowerIndex.find(borrowerKey(name, id));
+    return (it == borrowerIndex.end()) ? nullptr : it->second; // Return the canonical borrower or nullptr
+}
+
+// Helper function to return the canonical borrower for a name and id, registering it if needed
+Borrower* LCMS::registerBorrower(const string& name, const string& id)
+{
+    Borrower*& slot = borrowerIndex[borrowerKey(name, id)]; // Single probe for both lookup and insertion
+    if (slot == nullptr)
+    {
+        slot = borrowerPool.create(name, id); // First time this patron borrows: create the only object for them
+        this->borrowers.push_back(slot); // The borrowers vector owns the object
+    }
+    return slot;
 }
 
 // Method to find a book by title and display its details
 void LCMS :: findBook(string bookTitle)
 {
-    Book* b1 = find_book_helper(this->libTree->getRoot(), this->libTree, bookTitle); // Use the helper to find the book
+    if (view != nullptr) { view->findBook(bookTitle); return; } // Answer from the mapped snapshot
+    Book* b1 = lookupBook(bookTitle); // Use the title index to find the book
     if (b1 != nullptr) {
         cout << "Book found in the library:" << endl;
         b1->display(); // Display the book's details if found
@@ -205,9 +551,181 @@ void LCMS :: findBook(string bookTitle)
     }
 }
 
+// Method to display the books whose title or author has the words of a query
+void LCMS :: search(string terms)
+{
+    ensureWritable(); // The text index is built with the catalog in memory
+    MyVector<Book*> found;
+    textIndex.search(terms, found);
+    for (int i = 0; i < found.size(); ++i)
+    {
+        found[i]->display(); // Display the details of each match, in the order the books were indexed
+    }
+    cout << found.size() << " records found" << endl; // Print the count of found records
+}
+
+// Method to display the books whose title is a few typing errors away from a text
+void LCMS :: fuzzyFind(string text)
+{
+    ensureWritable(); // The trigram lists live in the text index, built with the catalog in memory
+    MyVector<TextIndex::Match> matches;
+    textIndex.fuzzy(text, FUZZY_RESULTS, matches);
+    for (int i = 0; i < matches.size(); ++i)
+    {
+        cout << "Match " << i + 1 << " (" << matches[i].distance << " edit(s), " << matches[i].overlap << " shared trigrams):" << endl;
+        matches[i].book->display(); // Display the details of each close title, closest first
+    }
+    cout << matches.size() << " records found" << endl; // Print the count of found records
+}
+
+// Method to display the books with an ISBN, given as an ISBN-10 or ISBN-13, with or without hyphens
+void LCMS :: findByIsbn(string isbn)
+{
+    ensureWritable(); // The ISBN index is built with the catalog in memory
+    uint64_t key;
+    if (!Isbn::key(isbn, key))
+    {
+        cout << isbn << " is not an ISBN-10 or ISBN-13." << endl;
+        return;
+    }
+    unordered_map<uint64_t, IsbnBucket>::iterator it = isbnIndex.find(key);
+    if (it == isbnIndex.end())
+    {
+        cout << "Book not found in the library." << endl;
+        return;
+    }
+
+    MyVector<Book*> books; // Books entered with the same ISBN in several categories, or under its other form
+    books.reserve(it->second.size());
+    for (int i = 0; i < it->second.size(); ++i) books.push_back(it->second[i]);
+    sort(books.begin(), books.end(), titleOrder); // Removals reorder the index, the output does not change with them
+    for (int i = 0; i < books.size(); ++i)
+    {
+        books[i]->display();
+    }
+    cout << books.size() << " records found" << endl; // Print the count of found records
+}
+
+// Method to display the books by an author, sorted by title
+void LCMS :: findByAuthor(string author)
+{
+    ensureWritable(); // The author index is built with the catalog in memory
+    const string* interned = Book::authors.find(author); // Authors no book has were never interned
+    unordered_map<const string*, BookGroup>::iterator it = authorIndex.end();
+    if (interned != nullptr) it = authorIndex.find(interned);
+    if (it == authorIndex.end())
+    {
+        cout << "No books by " << author << " in the library." << endl;
+        return;
+    }
+
+    MyVector<Book*> books;
+    books.reserve(it->second.size());
+    for (int i = 0; i < it->second.size(); ++i) books.push_back(it->second[i]);
+    sort(books.begin(), books.end(), titleOrder);
+    for (int i = 0; i < books.size(); ++i)
+    {
+        books[i]->display();
+    }
+    cout << books.size() << " records found" << endl; // Print the count of found records
+}
+
+// Helper function to read one year of a range; the whole text has to be the number
+static int parseYear(const string& text)
+{
+    size_t digits = (!text.empty() && text[0] == '-') ? 1 : 0; // A year before the common era
+    if (digits == text.size() || text.find_first_not_of("0123456789", digits) != string::npos)
+    {
+        throw invalid_argument("Invalid year \"" + text + "\", expected <from>-<to>");
+    }
+    return stoi(text);
+}
+
+// Method to display the books published in a range of years, optionally only those of a category;
+// the year index is walked from the first year of the range, so books of other years are never touched
+void LCMS :: findByYear(string range)
+{
+    ensureWritable(); // The year index is built with the catalog in memory
+    string years = range, category;
+    size_t space = range.find(' ');
+    if (space != string::npos) // The category path follows the range
+    {
+        years = range.substr(0, space);
+        category = range.substr(space + 1);
+    }
+    size_t dash = years.find('-', 1); // Past the minus sign of a first year before the common era
+    int from = parseYear(years.substr(0, dash));
+    int to = (dash == string::npos) ? from : parseYear(years.substr(dash + 1)); // A single year is a range of one
+    if (from > to)
+    {
+        throw invalid_argument("The range " + years + " ends before it starts");
+    }
+
+    Node* node = nullptr;
+    if (!category.empty())
+    {
+        node = libTree->getNode(category);
+        if (node == nullptr)
+        {
+            cout << "Category " << category << " does not exist" << endl;
+            return;
+        }
+    }
+
+    map<int, BookGroup>::iterator first = yearIndex.lower_bound(from), last = yearIndex.upper_bound(to);
+    size_t inRange = 0; // Books of the range, one step per year
+    for (map<int, BookGroup>::iterator it = first; it != last; ++it) inRange += it->second.size();
+
+    MyVector<Book*> books;
+    if (node == nullptr)
+    {
+        books.reserve(inRange);
+        for (map<int, BookGroup>::iterator it = first; it != last; ++it)
+        {
+            for (int i = 0; i < it->second.size(); ++i) books.push_back(it->second[i]);
+        }
+    }
+    else // Intersect from the smaller side: a subtree is one id range of nodes and one range of books in the flat layout
+    {
+        const FlatTree& flat = libTree->layout(); // Numbers the nodes, read node->flatId after it
+        uint32_t id = node->flatId, subtreeEnd = flat[id].subtreeEnd;
+        if (flat.subtreeBooks(id) < inRange) // Sweep the books of the category and keep those of the range
+        {
+            uint32_t end = flat.bookEnd(id);
+            for (uint32_t i = flat.bookBegin(id); i < end; ++i)
+            {
+                Book* book = flat.book(i);
+                if (book->publication_year >= from && book->publication_year <= to) books.push_back(book);
+            }
+        }
+        else // Walk the range and keep the books whose node lies in the subtree
+        {
+            for (map<int, BookGroup>::iterator it = first; it != last; ++it)
+            {
+                for (int i = 0; i < it->second.size(); ++i)
+                {
+                    uint32_t bookNode = it->second[i]->node->flatId;
+                    if (bookNode >= id && bookNode < subtreeEnd) books.push_back(it->second[i]);
+                }
+            }
+        }
+    }
+
+    sort(books.begin(), books.end(), [](Book* a, Book* b) {
+        if (a->publication_year != b->publication_year) return a->publication_year < b->publication_year;
+        return titleOrder(a, b);
+    });
+    for (int i = 0; i < books.size(); ++i)
+    {
+        books[i]->display();
+    }
+    cout << books.size() << " records found" << endl; // Print the count of found records
+}
+
 // Method to add a new book to the library
 void LCMS::addBook() 
 {
+    ensureWritable(); // The command needs the catalog in memory
     // Prompt the user to enter book details
     string title, author, isbn, category;
     int publn_year, total_copies, available_copies;
@@ -234,36 +752,43 @@ void LCMS::addBook()
     cout << "Enter Category: ";
     getline(cin, category); // Read the category
 
-    Node* node = libTree->createNode(category); // Create or find the node for the category
-    bool bookExists = false;
-    for (int i = 0; i < node->books.size(); ++i) 
-    {
-        if (node->books[i]->title == title) 
-        {
-            bookExists = true; // Check if the book already exists in the category
-            break;
-        }
-    }
-
-    if (!bookExists) { // If the book does not exist, add it
-        node->books.push_back(new Book(title, author, isbn, publn_year, total_copies, available_copies)); // Add the new book
-
-        Node* toUpdate = node; // Update book count for the category and its ancestors
-        while (toUpdate) 
-        {
-            libTree->updateBookCount(toUpdate, 1); // Update the book count
-            toUpdate = toUpdate->parent;
-        }
+    Book* book = addBookTo(category, title, author, isbn, publn_year, total_copies, available_copies);
+    if (book != nullptr) {
+        JournalRecord record = addRecord(category, book);
+        journalLog(record); // Durable before it is acknowledged
         cout << "Book " << title << " has been successfully added to the catalog." << endl;
     } else {
         cout << "A book with this title already exists in the category." << endl; // Inform the user if the book already exists
     }
 }
 
+// Helper method to add a book to a category, creating the category if needed; returns nullptr
+// and adds nothing if the category already holds a book with this title
+Book* LCMS::addBookTo(const string& category, const string& title, const string& author, const string& isbn,
+                      int publn_year, int total_copies, int available_copies)
+{
+    Node* node = libTree->createNode(category); // Create or find the node for the category
+    if (findInCategory(node, TextArena::ref(title)) != nullptr) return nullptr; // The first book with a title in a category wins
+
+    Book* book = libTree->getBookPool().create(libTree->getTitleArena(), title, author, isbn, publn_year, total_copies, available_copies); // Create the new book
+    libTree->addBook(node, book); // Add the new book to its category
+    indexBook(book); // Make the book reachable through the title index
+    indexGroups(book);
+
+    Node* toUpdate = node; // Update book count for the category and its ancestors
+    while (toUpdate) 
+    {
+        libTree->updateBookCount(toUpdate, 1); // Update the book count
+        toUpdate = toUpdate->parent;
+    }
+    return book;
+}
+
 // Method to edit details of an existing book
 void LCMS :: editBook(string bookTitle)
 {
-    Book* b1 = find_book_helper(this->libTree->getRoot(), this->libTree, bookTitle); // Find the book in the library
+    ensureWritable(); // The command needs the catalog in memory
+    Book* b1 = lookupBook(bookTitle); // Find the book in the library
  
     if (b1 == nullptr) 
     {
@@ -299,32 +824,21 @@ void LCMS :: editBook(string bookTitle)
                 getline(cin, parameter); // Read the new value for the chosen field
             }
 
-            // Update the selected field with the new value
-            switch (choice) 
+            if (choice >= 1 && choice <= 6)
             {
-                case 1:
-                    b1->title = parameter; // Update the title
-                    break;
-                case 2:
-                    b1->author = parameter; // Update the author
-                    break;
-                case 3:
-                    b1->isbn = parameter; // Update the ISBN
-                    break;
-                case 4:
-                    b1->publication_year = stoi(parameter); // Update the publication year
-                    break;
-                case 5:
-                    b1->total_copies = stoi(parameter); // Update the total copies
-                    break;
-                case 6:
-                    b1->available_copies = stoi(parameter); // Update the available copies
-                    break;
-                case 7:
-                    cout << "Changes made have been successfully saved to the book details" << endl;
-                    return; // Exit the editing loop
-                default:
-                    cout << "Invalid option, please try again." << endl; // Handle invalid options
+                setBookField(b1, choice, parameter); // Update the selected field with the new value
+                JournalRecord record = bookRecord(JOURNAL_EDIT_BOOK, b1);
+                record.put(choice).put(parameter);
+                journalLog(record);
+            }
+            else if (choice == 7)
+            {
+                cout << "Changes made have been successfully saved to the book details" << endl;
+                return; // Exit the editing loop
+            }
+            else
+            {
+                cout << "Invalid option, please try again." << endl; // Handle invalid options
             }
         } catch (exception &ex) 
         {
@@ -333,10 +847,52 @@ void LCMS :: editBook(string bookTitle)
     } while (true); // Repeat until the user chooses to exit
 }
 
+// Helper method to set one field of a book, numbered as in the editBook menu
+void LCMS :: setBookField(Book* b1, int field, const string& parameter)
+{
+    switch (field) 
+    {
+        case 1:
+            unindexBook(b1); // Drop the old title from the index
+            b1->setTitle(libTree->getTitleArena(), parameter); // Update the title
+            indexBook(b1); // Register the book under its new title
+            break;
+        case 2:
+            unindexAuthor(b1);
+            textIndex.remove(b1); // The words of the old author go with it
+            b1->author = Book::authors.intern(parameter); // Update the author
+            indexAuthor(b1);
+            textIndex.add(b1);
+            break;
+        case 3:
+            unindexIsbn(b1);
+            b1->isbn = Isbn(parameter); // Update the ISBN
+            indexIsbn(b1);
+            break;
+        case 4:
+        {
+            int16_t year = Book::toYear(stoi(parameter)); // Checked before the book leaves the index
+            unindexYear(b1);
+            b1->publication_year = year; // Update the publication year
+            indexYear(b1);
+            break;
+        }
+        case 5:
+            b1->total_copies = stoi(parameter); // Update the total copies
+            break;
+        case 6:
+            b1->available_copies = stoi(parameter); // Update the available copies
+            break;
+        default:
+            throw invalid_argument("Invalid book field " + to_string(field));
+    }
+}
+
 // Method for borrowing a book
 void LCMS::borrowBook(string bookTitle)
 {
-    Book* b1 = find_book_helper(this->libTree->getRoot(), this->libTree, bookTitle); // Find the book in the library
+    ensureWritable(); // The command needs the catalog in memory
+    Book* b1 = lookupBook(bookTitle); // Find the book in the library
 
     if (b1 == nullptr)
     {
@@ -352,64 +908,15 @@ void LCMS::borrowBook(string bookTitle)
         cout << "Enter borrower's id: ";
         cin >> id;
 
-        Borrower* borrower = new Borrower(name, id); // Create a new borrower object
-        bool foundInCurrent = false, foundInAll = false, foundInLib = false;
-
-        // Check if the borrower is already borrowing the book
-        for (int i = 0; i < b1->currentBorrowers.size() && !foundInCurrent; ++i)
-        {
-            if (b1->currentBorrowers[i]->name == name && b1->currentBorrowers[i]->id == id)
-            {
-                foundInCurrent = true; // Mark as found in current borrowers
-                break;
-            }
-        }
-
-        // If the borrower is not already borrowing the book, proceed
-        if (!foundInCurrent)
+        if (checkoutBook(b1, name, id))
         {
-            // Check if the borrower has ever borrowed this book before
-            for (int i = 0; i < b1->allBorrowers.size() && !foundInAll; ++i)
-            {
-                if (b1->allBorrowers[i]->name == name && b1->allBorrowers[i]->id == id)
-                {
-                    foundInAll = true; // Mark as found in all borrowers
-                    break;
-                }
-            }
-
-            // Check if the borrower is registered in the library system
-            for (int i = 0; i < this->borrowers.size() && !foundInLib; ++i)
-            {
-                if (this->borrowers[i]->name == name && this->borrowers[i]->id == id)
-                {
-                    foundInLib = true; // Mark as found in library borrowers
-                    break;
-                }
-            }
-
-            // If the borrower is not found in all borrowers, add them
-            if (!foundInAll)
-            {
-                b1->allBorrowers.push_back(borrower);
-            }
-            // If the borrower is not found in library borrowers, add them
-            if (!foundInLib)
-            {
-                this->borrowers.push_back(borrower);
-            }
-
-            // Add the borrower to the current borrowers of the book
-            b1->currentBorrowers.push_back(borrower);
-            // Add the book to the list of books borrowed by the borrower
-            borrower->books_borrowed.push_back(b1);
-
-            b1->available_copies--; // Decrement the available copies of the book
+            JournalRecord record = bookRecord(JOURNAL_BORROW, b1);
+            record.put(name).put(id);
+            journalLog(record); // Durable before it is acknowledged
             cout << "Book " << b1->title << " has been issued to " << name << endl; // Inform the user that the book has been issued
         }
         else
         {
-            delete borrower; // If the borrower is already borrowing the book, delete the newly created borrower object
             cout << "Book with title: " << b1->title << " is already borrowed by: " << name << endl; // Inform the user
         }
     }
@@ -419,10 +926,32 @@ void LCMS::borrowBook(string bookTitle)
     }
 }
 
+// Helper method to lend a copy of a book to a patron; returns false if the patron already holds one
+bool LCMS::checkoutBook(Book* b1, const string& name, const string& id)
+{
+    Borrower* borrower = findBorrower(name, id); // Look up the patron without allocating
+
+    // Check if the borrower is already borrowing the book
+    if (borrower != nullptr && loans.contains(borrower, b1))
+    {
+        return false;
+    }
+
+    borrower = registerBorrower(name, id); // Reuse the patron's object, creating it on the first checkout
+    loans.addHistory(b1, borrower); // Add the borrower to the book's history unless they borrowed it before
+
+    // Record the loan, which makes the borrower a current borrower of the book
+    loans.checkout(borrower, b1);
+
+    b1->available_copies--; // Decrement the available copies of the book
+    return true;
+}
+
 // Method for returning a borrowed book
 void LCMS::returnBook(string bookTitle) 
 {
-    Book* b1 = find_book_helper(this->libTree->getRoot(), this->libTree, bookTitle); // Find the book in the library
+    ensureWritable(); // The command needs the catalog in memory
+    Book* b1 = lookupBook(bookTitle); // Find the book in the library
     if (b1 == nullptr) 
     {
         cout << "Book not found in the library." << endl; // Inform the user if the book is not found
@@ -436,34 +965,35 @@ void LCMS::returnBook(string bookTitle)
     cout << "Enter borrower's id: ";
     cin >> id;
 
-    // Loop through the list of current borrowers of the book
-    for (int borrowerIndex = 0; borrowerIndex < b1->currentBorrowers.size(); ++borrowerIndex) 
+    if (checkinBook(b1, name, id)) // Close the loan if the borrower holds the book
     {
-        Borrower* currentBorrower = b1->currentBorrowers[borrowerIndex];
-        if (currentBorrower->name == name && currentBorrower->id == id) // Check if the borrower matches the input
-        {
-            // Loop through the list of books borrowed by the borrower to find the book being returned
-            for (int bookIndex = 0; bookIndex < currentBorrower->books_borrowed.size(); ++bookIndex) 
-            {
-                if (currentBorrower->books_borrowed[bookIndex]->title == bookTitle) 
-                {
-                    currentBorrower->books_borrowed.erase(bookIndex); // Remove the book from the borrower's list
-                    b1->available_copies++; // Increment the available copies of the book
-                    cout << "Book has been successfully returned." << endl; // Inform the user that the book has been returned
-                    b1->currentBorrowers.erase(borrowerIndex); // Remove the borrower from the list of current borrowers
-                    return; // Exit the method
-                }
-            }
-        }
+        JournalRecord record = bookRecord(JOURNAL_RETURN, b1);
+        record.put(name).put(id);
+        journalLog(record); // Durable before it is acknowledged
+        cout << "Book has been successfully returned." << endl; // Inform the user that the book has been returned
+        return; // Exit the method
     }
 
     cout << "Borrower not found." << endl; // Inform the user if the borrower is not found in the list of current borrowers
 }
 
+// Helper method to take back a copy of a book from a patron; returns false if the patron holds none
+bool LCMS::checkinBook(Book* b1, const string& name, const string& id)
+{
+    Borrower* borrower = findBorrower(name, id); // Look up the borrower in the registry
+    if (borrower == nullptr || !loans.checkin(borrower, b1))
+    {
+        return false;
+    }
+    b1->available_copies++; // Increment the available copies of the book
+    return true;
+}
+
 // Method to list the current borrowers of a book
 void LCMS :: listCurrentBorrowers(string bookTitle)
 {
-    Book* b1 = find_book_helper(this->libTree->getRoot(), this->libTree, bookTitle); // Find the book in the library
+    ensureWritable(); // The command needs the catalog in memory
+    Book* b1 = lookupBook(bookTitle); // Find the book in the library
     if (b1 == nullptr) 
     {
         cout << "Book not found in the library." << endl; // Inform the user if the book is not found
@@ -471,9 +1001,10 @@ void LCMS :: listCurrentBorrowers(string bookTitle)
     else
     {
         // Loop through the list of current borrowers and print their details
-        for (int i = 0; i < b1->currentBorrowers.size(); ++i)
+        for (int i = 0; i < loans.countByBook(b1); ++i)
         {
-            cout << i + 1 << " " << b1->currentBorrowers[i]->name << "(" << b1->currentBorrowers[i]->id << ")" << endl;
+            Borrower* borrower = loans.borrowerAt(b1, i);
+            cout << i + 1 << " " << borrower->name << "(" << borrower->id << ")" << endl;
         }
     }
 }
@@ -481,7 +1012,8 @@ void LCMS :: listCurrentBorrowers(string bookTitle)
 // Method to list all borrowers that have ever borrowed a book
 void LCMS :: listAllBorrowers(string bookTitle)
 {
-    Book* b1 = find_book_helper(this->libTree->getRoot(), this->libTree, bookTitle); // Find the book in the library
+    ensureWritable(); // The command needs the catalog in memory
+    Book* b1 = lookupBook(bookTitle); // Find the book in the library
     if (b1 == nullptr) 
     {
         cout << "Book not found in the library." << endl; // Inform the user if the book is not found
@@ -489,9 +1021,10 @@ void LCMS :: listAllBorrowers(string bookTitle)
     else
     {
         // Loop through the list of all borrowers and print their details
-        for (int i = 0; i < b1->allBorrowers.size(); ++i)
+        for (int i = 0; i < loans.historyCount(b1); ++i)
         {
-            cout << i + 1 << " " << b1->allBorrowers[i]->name << "(" << b1->allBorrowers[i]->id << ")" << endl;
+            Borrower* borrower = loans.historyAt(b1, i);
+            cout << i + 1 << " " << borrower->name << "(" << borrower->id << ")" << endl;
         }
     }
 }
@@ -499,36 +1032,31 @@ void LCMS :: listAllBorrowers(string bookTitle)
 // Method to display the books a borrower has ever borrowed
 void LCMS :: listBooks(string borrower_name_id)
 {
+    ensureWritable(); // The command needs the catalog in memory
     string name, id;
     stringstream iss(borrower_name_id); // Use stringstream to split the input string
     getline(iss, name, ','); // Extract the borrower's name
     getline(iss, id); // Extract the borrower's ID
 
-    bool borrowerFound = false; // Flag to track if the borrower is found
-    for (int i = 0; i < this->borrowers.size(); ++i) // Loop through the list of borrowers in the library
+    Borrower* borrower = findBorrower(name, id); // Look up the borrower in the registry
+    if (borrower != nullptr)
     {
-        if (this->borrowers[i]->name == name && this->borrowers[i]->id == id) // Check if the borrower matches the input
+        cout << "Books borrowed by " << name << " (ID: " << id << "):" << endl; // Print the borrower's details
+        if (loans.countByBorrower(borrower) == 0) // Check if the borrower has borrowed any books
         {
-            borrowerFound = true; // Mark the borrower as found
-            cout << "Books borrowed by " << name << " (ID: " << id << "):" << endl; // Print the borrower's details
-            if (this->borrowers[i]->books_borrowed.empty()) // Check if the borrower has borrowed any books
-            {
-                cout << "No books borrowed." << endl; // Inform the user if no books have been borrowed
-            } 
-            else 
+            cout << "No books borrowed." << endl; // Inform the user if no books have been borrowed
+        } 
+        else 
+        {
+            // Loop through the list of books borrowed by the borrower and print their titles
+            for (int j = 0; j < loans.countByBorrower(borrower); ++j) 
             {
-                // Loop through the list of books borrowed by the borrower and print their titles
-                for (int j = 0; j < this->borrowers[i]->books_borrowed.size(); ++j) 
-                {
-                    Book* book = this->borrowers[i]->books_borrowed[j];
-                    cout << j + 1 << ": " << book->title << endl; 
-                }
+                Book* book = loans.bookAt(borrower, j);
+                cout << j + 1 << ": " << book->title << endl; 
             }
-            break; // Break the loop once the borrower is found
         }
     }
-
-    if (!borrowerFound) // If the borrower is not found
+    else // If the borrower is not found
     {
         cout << "Borrower " << name << " (ID: " << id << ") not found." << endl; // Inform the user
     }
@@ -536,6 +1064,7 @@ void LCMS :: listBooks(string borrower_name_id)
 
 // Method to remove a book from the library
 void LCMS::removeBook(string bookTitle) {
+    ensureWritable(); // The command needs the catalog in memory
     string userResponse; // String to store the user's response
     while (true) 
     {
@@ -546,9 +1075,13 @@ void LCMS::removeBook(string bookTitle) {
         if (userResponse == "yes") 
         {
             // If the user confirms, attempt to delete the book
-            bool removed = removeBookHelper(this->libTree->getRoot(), bookTitle); // Use the helper to remove the book
-            if (removed) 
+            Book* book = lookupBook(bookTitle); // Find the book through the title index
+            if (book != nullptr) 
             {
+                JournalRecord record = bookRecord(JOURNAL_REMOVE_BOOK, book); // Named by position while it is still in place
+                dropBook(book); // Forget the book before it is freed
+                libTree->removeBook(book->node, book); // Remove the book from the category that holds it
+                journalLog(record);
                 cout << "Book " << bookTitle << " removed successfully." << endl; // Inform the user if the book was successfully removed
             } else 
             {
@@ -563,40 +1096,21 @@ void LCMS::removeBook(string bookTitle) {
     }
 }
 
-// Helper method to remove a book recursively
-bool LCMS::removeBookHelper(Node* node, const string& bookTitle) {
-    if (node == nullptr) return false; // If the node is null, return false indicating the book was not found
-
-    // Attempt to remove the book from the current node
-    bool foundAndRemoved = libTree->removeBook(node, bookTitle);
-    if (foundAndRemoved) {
-        // If the book was found and removed, return true
-        return true;
-    }
-
-    // If the book was not found in the current node, search in the children nodes
-    for (int i = 0; i < node->children.size(); ++i) {
-        Node* child = node->children[i];
-        if (removeBookHelper(child, bookTitle)) {
-            // If the book was found and removed in a child node, return true
-            return true;
-        }
-    }
-
-    // If the book was not found in any nodes, return false
-    return false;
-}
-
 // Method to add a new category to the catalog
 void LCMS :: addCategory(string category)
 {
+    ensureWritable(); // The command needs the catalog in memory
     this->libTree->createNode(category); // Create a new node for the category
+    JournalRecord record(JOURNAL_ADD_CATEGORY);
+    record.put(category);
+    journalLog(record);
     cout << category << " has been successfully created." << endl; // Inform the user that the category has been added
 }
 
 // Method to find a category in the catalog
 void LCMS :: findCategory(string category)
 {
+    if (view != nullptr) { view->findCategory(category); return; } // Answer from the mapped snapshot
     if (libTree->getNode(category) != nullptr) // Check if the category exists in the library
     {
         cout << "Category " << category << " was found in the catalog" << endl; // Inform the user if the category is found
@@ -610,11 +1124,16 @@ void LCMS :: findCategory(string category)
 // Method to remove a category from the catalog
 void LCMS :: removeCategory(string category)
 {
+    ensureWritable(); // The command needs the catalog in memory
     Node* n1 = libTree->getNode(category); // Find the node for the category
 
     if(n1 != nullptr)
     {
-        libTree->remove(n1->parent, n1->name); // Remove the category node from the tree
+        dropSubtree(n1); // Forget the books of the category before they are freed
+        libTree->remove(n1->parent, *n1->name); // Remove the category node from the tree
+        JournalRecord record(JOURNAL_REMOVE_CATEGORY);
+        record.put(category);
+        journalLog(record);
         cout << category << " has been successfully removed" << endl; // Inform the user that the category has been removed
     }
     else
@@ -626,18 +1145,637 @@ void LCMS :: removeCategory(string category)
 // Method to edit a category in the catalog
 void LCMS :: editCategory(string category)
 {
+    ensureWritable(); // The command needs the catalog in memory
     Node* n1 = libTree->getNode(category); // Find the node for the category
     string name;
 
+    if (n1 == nullptr)
+    {
+        throw runtime_error("Category does not exist"); // Throw an exception if the category does not exist
+    }
     cout << "Enter name of the category" << endl; // Prompt the user for the new name of the category
     cin >> name;
-    n1->name = name; // Update the name of the category
+    libTree->rename(n1, name); // Update the name of the category and its parent's child index
+    JournalRecord record(JOURNAL_RENAME_CATEGORY);
+    record.put(category).put(name);
+    journalLog(record);
 
     cout << "Category edited successfully" << endl; // Inform the user that the category has been edited
 }
 
+// Method to show or set the number of threads used by bulk operations such as import
+void LCMS :: setThreads(string count)
+{
+    if (!count.empty())
+    {
+        int threads = stoi(count);
+        if (threads < 1)
+        {
+            throw invalid_argument("Number of threads must be at least 1");
+        }
+        this->workerThreads = threads;
+    }
+    cout << "Using " << this->workerThreads << " thread(s)" << endl;
+}
+
+// Helper method to free everything the catalog owns and start over with a given tree
+void LCMS :: clear(Tree* tree)
+{
+    delete this->libTree; // Frees every node and book, a slab at a time
+    this->libTree = tree;
+    this->borrowerPool.clear();
+    this->borrowers.clear();
+    this->borrowerIndex.clear();
+    this->titleIndex.clear();
+    this->isbnIndex.clear();
+    this->authorIndex.clear();
+    this->yearIndex.clear();
+    this->textIndex.clear();
+    this->loans.clear();
+}
+
+// Tables of a snapshot being written
+struct SnapshotBuilder
+{
+    MyVector<SnapNode> nodes;
+    MyVector<SnapBook> books;
+    MyVector<uint32_t> history;
+    MyVector<Book*> bookPtrs;					// index in books -> book
+    string strings;								// string pool
+    unordered_map<Borrower*, uint32_t> borrowerIds;	// borrower -> index in borrowers
+
+    unordered_map<const string*, SnapString> interned;	// interned string -> its one copy in the pool
+
+    // Append a string to the pool and return its reference
+    SnapString add(const char* text, size_t length)
+    {
+        SnapString ref = { strings.size(), length };
+        strings.append(text, length);
+        return ref;
+    }
+
+    SnapString add(const string& text)
+    {
+        return add(text.data(), text.size());
+    }
+
+    // Append an interned string the first time it is seen, later uses share the same bytes
+    SnapString add(const string* text)
+    {
+        unordered_map<const string*, SnapString>::iterator it = interned.find(text);
+        if (it != interned.end()) return it->second;
+        SnapString ref = add(*text);
+        interned[text] = ref;
+        return ref;
+    }
+};
+
+// Recursive helper method to append a node, its books and its children in pre-order
+void LCMS :: save_helper(Node* node, uint32_t parent, uint32_t depth, SnapshotBuilder& out)
+{
+    uint32_t index = out.nodes.size();
+    SnapNode record;
+    record.name = out.add(node->name);
+    record.parent = parent;
+    record.firstBook = out.books.size();
+    record.ownBooks = node->books.size();
+    record.bookCount = node->bookCount;
+    record.depth = depth;
+    out.nodes.push_back(record);
+
+    for (int i = 0; i < node->books.size(); i++) // The books of a node are contiguous
+    {
+        Book* book = node->books[i];
+        SnapBook entry;
+        entry.title = out.add(book->title, TextArena::length(book->title));
+        entry.author = out.add(book->author);
+        entry.isbn = book->isbn.isPacked() ? out.add(book->isbn.str()) : out.add(book->isbn.text()); // Formatted ISBNs repeat, write each once
+        entry.publicationYear = book->publication_year;
+        entry.totalCopies = book->total_copies;
+        entry.availableCopies = book->available_copies;
+        entry.node = index;
+        entry.historyFirst = out.history.size();
+        entry.historyCount = loans.historyCount(book);
+        for (uint32_t j = 0; j < entry.historyCount; j++)
+        {
+            out.history.push_back(out.borrowerIds[loans.historyAt(book, j)]);
+        }
+        out.bookPtrs.push_back(book);
+        out.books.push_back(entry);
+    }
+
+    for (int i = 0; i < node->children.size(); i++)
+    {
+        save_helper(node->children[i], index, depth + 1, out);
+    }
+    out.nodes[index].subtreeEnd = out.nodes.size(); // The subtree ends where the next sibling starts
+}
+
+// Helper function to write bytes at an offset of a file, retrying short writes
+static void writeAt(int fd, uint64_t offset, const void* data, size_t bytes)
+{
+    const char* cursor = static_cast<const char*>(data);
+    while (bytes > 0)
+    {
+        ssize_t written = pwrite(fd, cursor, bytes, offset);
+        if (written < 0)
+        {
+            throw runtime_error("Couldn't save the snapshot");
+        }
+        cursor += written;
+        offset += written;
+        bytes -= written;
+    }
+}
+
+// Helper function to write a table at the end of the file, padded to 8 bytes; returns where it starts
+static uint64_t writeTable(int fd, uint64_t& end, const void* data, size_t bytes)
+{
+    uint64_t offset = end;
+    if (bytes > 0) writeAt(fd, end, data, bytes);
+    static const char padding[8] = { 0 };
+    writeAt(fd, end + bytes, padding, (8 - bytes % 8) % 8);
+    end += bytes + (8 - bytes % 8) % 8;
+    return offset;
+}
+
+// Helper function to flush the directory holding a file, so a rename into it survives a power failure
+static bool syncDirectory(const string& path)
+{
+    size_t slash = path.rfind('/');
+    string directory = (slash == string::npos) ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+// Method to write the whole catalog, borrowers and loans to a binary snapshot
+void LCMS :: save(string path)
+{
+    ensureWritable(); // The command needs the catalog in memory
+    writeSnapshot(path, journal != nullptr ? journal->lastSequence() : 0);
+}
+
+// Helper method to write a snapshot that includes the journal up to a given record
+void LCMS :: writeSnapshot(const string& path, uint64_t sequence)
+{
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+    SnapshotBuilder out;
+
+    MyVector<SnapBorrower> borrowerTable; // Borrowers first, the books refer to them by index
+    for (int i = 0; i < this->borrowers.size(); i++)
+    {
+        SnapBorrower entry = { out.add(this->borrowers[i]->name), out.add(this->borrowers[i]->id) };
+        out.borrowerIds[this->borrowers[i]] = i;
+        borrowerTable.push_back(entry);
+    }
+
+    save_helper(libTree->getRoot(), SNAPSHOT_NONE, 0, out); // Nodes and books in pre-order
+
+    MyVector<SnapLoan> loanTable; // Loans in per-book order, so reloading keeps the borrower order of each book
+    for (int i = 0; i < out.bookPtrs.size(); i++)
+    {
+        for (int j = 0; j < loans.countByBook(out.bookPtrs[i]); j++)
+        {
+            SnapLoan loan = { out.borrowerIds[loans.borrowerAt(out.bookPtrs[i], j)], (uint32_t)i };
+            loanTable.push_back(loan);
+        }
+    }
+
+    MyVector<uint32_t> titleOrder(out.books.size()); // Books sorted by title, so a read-only view can binary search them
+    for (int i = 0; i < out.books.size(); i++) titleOrder.push_back(i);
+    if (!titleOrder.empty())
+    {
+        stable_sort(&titleOrder[0], &titleOrder[0] + titleOrder.size(), [&out](uint32_t a, uint32_t b)
+        {
+            return TextArena::ref(out.bookPtrs[a]->title) < TextArena::ref(out.bookPtrs[b]->title);
+        });
+    }
+
+    string temp = path + ".tmp"; // Write next to the target and rename, so a crash never leaves half a snapshot
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        throw runtime_error("Couldn't save the snapshot");
+    }
+
+    SnapHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.journalSequence = sequence;
+    header.nodeCount = out.nodes.size();
+    header.bookCount = out.books.size();
+    header.borrowerCount = borrowerTable.size();
+    header.loanCount = loanTable.size();
+    header.historyCount = out.history.size();
+    try
+    {
+        uint64_t end = 0;
+        writeTable(fd, end, &header, sizeof(header)); // Written again once the offsets are known
+
+        header.nodesOffset = writeTable(fd, end, out.nodes.empty() ? nullptr : &out.nodes[0], out.nodes.size() * sizeof(SnapNode));
+        header.booksOffset = writeTable(fd, end, out.books.empty() ? nullptr : &out.books[0], out.books.size() * sizeof(SnapBook));
+        header.borrowersOffset = writeTable(fd, end, borrowerTable.empty() ? nullptr : &borrowerTable[0], borrowerTable.size() * sizeof(SnapBorrower));
+        header.loansOffset = writeTable(fd, end, loanTable.empty() ? nullptr : &loanTable[0], loanTable.size() * sizeof(SnapLoan));
+        header.historyOffset = writeTable(fd, end, out.history.empty() ? nullptr : &out.history[0], out.history.size() * sizeof(uint32_t));
+        header.stringsOffset = writeTable(fd, end, out.strings.data(), out.strings.size());
+        header.stringsSize = out.strings.size();
+        header.titlesOffset = writeTable(fd, end, titleOrder.empty() ? nullptr : &titleOrder[0], titleOrder.size() * sizeof(uint32_t));
+        writeAt(fd, 0, &header, sizeof(header));
+    }
+    catch (...)
+    {
+        close(fd);
+        remove(temp.c_str());
+        throw;
+    }
+
+    // The data reaches the disk before the rename, and the rename before the caller may drop the journal
+    bool synced = fsync(fd) == 0;
+    if (close(fd) != 0 || !synced || rename(temp.c_str(), path.c_str()) != 0)
+    {
+        remove(temp.c_str());
+        throw runtime_error("Couldn't save the snapshot");
+    }
+    if (!syncDirectory(path))
+    {
+        throw runtime_error("Couldn't save the snapshot");
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << header.bookCount << " books, " << header.borrowerCount << " borrowers and " << header.loanCount
+         << " loans have been saved to " << path << " in " << seconds << " s" << endl;
+}
+
+// Method to replace the whole catalog with the content of a binary snapshot
+void LCMS :: load(string path)
+{
+    loadSnapshot(path);
+    if (journal != nullptr) checkpoint(); // The journal cannot replay a wholesale replacement, start it over from here
+}
+
+// Helper method to replace the catalog with a snapshot; returns the last journal record the snapshot includes
+uint64_t LCMS :: loadSnapshot(const string& path)
+{
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+    MappedFile file(path); // Read the snapshot in place
+    SnapshotReader snap(file); // Validates every table before anything is built
+    const SnapHeader* header = snap.header;
+
+    // Build the new catalog next to the current one, so a bad file leaves the catalog untouched
+    unique_ptr<Tree> tree(new Tree(snap.str(snap.nodes[0].name))); // Freed with its pools if building it fails
+    MyVector<Node*> nodePtrs(header->nodeCount); // Allocated once for the whole table
+    MyVector<Book*> bookPtrs(header->bookCount);
+    MyVector<Borrower*> borrowerPtrs(header->borrowerCount);
+    Pool<Borrower> newBorrowers; // Becomes the borrower pool once the new catalog is swapped in
+    nodePtrs.push_back(tree->getRoot());
+    for (uint32_t i = 1; i < header->nodeCount; i++) // Parents precede their children in pre-order
+    {
+        Node* parent = nodePtrs[snap.nodes[i].parent];
+        tree->insert(parent, snap.str(snap.nodes[i].name));
+        nodePtrs.push_back(parent->children[parent->children.size() - 1]);
+    }
+    for (uint32_t i = 0; i < header->bookCount; i++)
+    {
+        const SnapBook& entry = snap.books[i];
+        Book* book = tree->getBookPool().create(tree->getTitleArena(), snap.str(entry.title), snap.str(entry.author), snap.str(entry.isbn),
+                                                entry.publicationYear, entry.totalCopies, entry.availableCopies);
+        tree->addBook(nodePtrs[entry.node], book); // The tree owns the book from here on
+        bookPtrs.push_back(book);
+    }
+    for (uint32_t i = 0; i < header->borrowerCount; i++)
+    {
+        borrowerPtrs.push_back(newBorrowers.create(snap.str(snap.borrowers[i].name), snap.str(snap.borrowers[i].id)));
+    }
+
+    // Swap in the new catalog and rebuild the indices over it, sized once for the whole snapshot
+    clear(tree.release());
+    borrowerPool.swap(newBorrowers);
+    delete view; // The loaded catalog replaces a read-only one too
+    view = nullptr;
+    titleIndex.reserve(header->bookCount);
+    isbnIndex.reserve(header->bookCount);
+    borrowerIndex.reserve(header->borrowerCount);
+    for (int i = 0; i < borrowerPtrs.size(); i++)
+    {
+        Borrower* borrower = borrowerPtrs[i];
+        Borrower*& slot = borrowerIndex[borrowerKey(borrower->name, borrower->id)];
+        if (slot == nullptr) slot = borrower; // A well-formed snapshot has no duplicate borrowers
+        this->borrowers.push_back(borrower);
+    }
+    for (int i = 0; i < bookPtrs.size(); i++)
+    {
+        Book* book = bookPtrs[i];
+        indexBook(book);
+        indexGroups(book);
+        for (uint32_t j = 0; j < snap.books[i].historyCount; j++)
+        {
+            loans.addHistory(book, borrowerPtrs[snap.history[snap.books[i].historyFirst + j]]);
+        }
+    }
+    for (uint32_t i = 0; i < header->loanCount; i++)
+    {
+        Borrower* borrower = borrowerPtrs[snap.loans[i].borrower];
+        Book* book = bookPtrs[snap.loans[i].book];
+        if (!loans.contains(borrower, book)) loans.checkout(borrower, book);
+    }
+    libTree->recountBooks(); // Counts are derived data, do not trust the file for them
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << header->bookCount << " books, " << header->borrowerCount << " borrowers and " << header->loanCount
+         << " loans have been loaded from " << path << " in " << seconds << " s" << endl;
+    return snap.journalSequence;
+}
+
+// Method to serve queries straight from a mapped snapshot. The catalog in memory is freed:
+// lookups read the file in place and a command that needs objects loads them on first use
+void LCMS :: openReadOnly(string path)
+{
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+    if (journal != nullptr)
+    {
+        throw runtime_error("The catalog is journaled, it cannot be opened read-only");
+    }
+    CatalogView* opened = new CatalogView(path); // Validates the file before the current catalog is dropped
+    clear(new Tree(*libTree->getRoot()->name));
+    delete view;
+    view = opened;
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << view->bookCount() << " books are served read-only from " << path << " in " << seconds << " s" << endl;
+}
+
+// Method to materialize the read-only snapshot, so the command that follows can change or list objects
+void LCMS :: ensureWritable()
+{
+    if (view == nullptr) return; // The catalog is already in memory
+    cout << "Loading " << view->getPath() << " into memory" << endl;
+    string path = view->getPath(); // A copy, the view goes away while the snapshot loads
+    loadSnapshot(path); // Drops the view once the catalog is built
+}
+
+// Helper method to build the journal record that adds a book to a category
+JournalRecord LCMS :: addRecord(const string& category, Book* book)
+{
+    JournalRecord record(JOURNAL_ADD_BOOK);
+    record.put(category).put(string(book->title, TextArena::length(book->title))).put(*book->author).put(book->isbn.str());
+    record.put(book->publication_year).put(book->total_copies).put(book->available_copies);
+    return record;
+}
+
+// Helper method to start a journal record about a book, named by its category and its position there
+JournalRecord LCMS :: bookRecord(JournalOp op, Book* book)
+{
+    int position = 0;
+    while (book->node->books[position] != book) position++; // The book is always in its node
+    JournalRecord record(op);
+    record.put(book->node->getCategory(book->node)).put(position);
+    return record;
+}
+
+// Helper method to find the book a journal record names
+Book* LCMS :: journalBook(JournalRecord& record)
+{
+    Node* node = libTree->getNode(record.getString());
+    int position = record.getInt();
+    if (node == nullptr || position < 0 || position >= node->books.size())
+    {
+        throw runtime_error("Invalid journal record " + to_string(record.getSequence()));
+    }
+    return node->books[position];
+}
+
+// Helper method to make a record durable before the command that made it is acknowledged
+void LCMS :: journalLog(JournalRecord& record)
+{
+    if (journal != nullptr) journal->commit(journal->append(record));
+}
+
+// Helper method to wait for the records of a batch, queued with Journal::append
+void LCMS :: journalCommit(uint64_t sequence)
+{
+    if (journal != nullptr && sequence != 0) journal->commit(sequence);
+}
+
+// Helper method to apply one journal record to the catalog, the way the command that wrote it did
+void LCMS :: applyRecord(JournalRecord& record)
+{
+    switch (record.getOp())
+    {
+        case JOURNAL_ADD_BOOK:
+        {
+            string category = record.getString(), title = record.getString(), author = record.getString(), isbn = record.getString();
+            int year = record.getInt(), total = record.getInt();
+            addBookTo(category, title, author, isbn, year, total, record.getInt());
+            break;
+        }
+        case JOURNAL_EDIT_BOOK:
+        {
+            Book* book = journalBook(record);
+            int field = record.getInt();
+            setBookField(book, field, record.getString());
+            break;
+        }
+        case JOURNAL_REMOVE_BOOK:
+        {
+            Book* book = journalBook(record);
+            dropBook(book); // Forget the book before it is freed
+            libTree->removeBook(book->node, book);
+            break;
+        }
+        case JOURNAL_BORROW:
+        case JOURNAL_RETURN:
+        {
+            Book* book = journalBook(record);
+            string name = record.getString(), id = record.getString();
+            if (record.getOp() == JOURNAL_BORROW) checkoutBook(book, name, id);
+            else checkinBook(book, name, id);
+            break;
+        }
+        case JOURNAL_ADD_CATEGORY:
+            libTree->createNode(record.getString());
+            break;
+        case JOURNAL_REMOVE_CATEGORY:
+        case JOURNAL_RENAME_CATEGORY:
+        {
+            Node* node = libTree->getNode(record.getString());
+            if (node == nullptr || node->parent == nullptr)
+            {
+                throw runtime_error("Invalid journal record " + to_string(record.getSequence()));
+            }
+            if (record.getOp() == JOURNAL_RENAME_CATEGORY)
+            {
+                libTree->rename(node, record.getString());
+            }
+            else
+            {
+                dropSubtree(node); // Forget the books of the category before they are freed
+                libTree->remove(node->parent, *node->name);
+            }
+            break;
+        }
+        default:
+            throw runtime_error("Invalid journal record " + to_string(record.getSequence()));
+    }
+}
+
+// Method to make the catalog durable under a base path: load <base>.snap if there is one, replay
+// <base>.journal on top of it, then journal every change until the next checkpoint
+void LCMS :: openJournal(string base)
+{
+    if (journal != nullptr)
+    {
+        throw runtime_error("The journal " + journalBase + ".journal is already open");
+    }
+    ensureWritable(); // The journal records changes to the catalog in memory
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+
+    string snapshotPath = base + ".snap";
+    uint64_t sequence = 0; // Last record already in the snapshot
+    if (ifstream(snapshotPath.c_str()).good())
+    {
+        sequence = loadSnapshot(snapshotPath);
+    }
+
+    int replayed = 0;
+    sequence = Journal::replay(base + ".journal", sequence, [this, &replayed](JournalRecord& record)
+    {
+        applyRecord(record);
+        replayed++;
+    });
+    journal = new Journal(base + ".journal", sequence + 1);
+    journalBase = base;
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << replayed << " journal records have been replayed from " << base << ".journal in " << seconds << " s" << endl;
+}
+
+// Method to write the catalog to <base>.snap and empty the journal it makes redundant. The snapshot
+// names the last record it includes, so a crash before the journal is emptied replays nothing twice.
+// writeSnapshot returns only once the snapshot and its rename are on disk, and throws otherwise,
+// so the journal is never emptied while the records it holds are not yet safe elsewhere
+void LCMS :: checkpoint()
+{
+    if (journal == nullptr)
+    {
+        throw runtime_error("No journal is open, start the program with a catalog path to open one");
+    }
+    writeSnapshot(journalBase + ".snap", journal->lastSequence());
+    journal->reset();
+    cout << "The journal " << journalBase << ".journal has been emptied" << endl;
+}
+
+// Helper function to print the counters of one pool as a row of the memstats table
+template <typename T>
+static void printPoolStats(const string& name, const Pool<T>& pool)
+{
+    cout << left << setw(12) << name << right << setw(12) << pool.live() << setw(12) << pool.created()
+         << setw(12) << pool.reused() << setw(10) << pool.slabsHeld() << setw(14) << pool.bytes() << endl;
+}
+
+// Helper function to print the counters of one kind of list as a row of the memstats table
+static void printListStats(const string& name, long long lists, long long spilled, long long heapBytes)
+{
+    cout << left << setw(20) << name << right << setw(12) << lists << setw(12) << spilled << setw(14) << heapBytes << endl;
+}
+
+// Helper function to get the memory a string would take as a copy of its own
+static long long copyBytes(const string& text)
+{
+    return sizeof(string) + ((text.size() > 15) ? text.size() + 1 : 0); // Short strings fit inside the object
+}
+
+// How the nodes and books of the catalog store their fields, for memstats
+struct FieldStats
+{
+    long long nodes;			// nodes visited
+    long long nameBytes;		// their names as a std::string each
+    long long books;			// books visited
+    long long authorBytes;		// their authors as a std::string each
+    long long packedIsbns;		// ISBNs held as packed digits
+};
+
+// Helper method to add up what the names and authors of a subtree would take if every node and book kept a copy
+void LCMS :: fieldStats(Node* node, FieldStats& stats)
+{
+    stats.nodes++;
+    stats.nameBytes += copyBytes(*node->name);
+    for (Book* book : node->books)
+    {
+        stats.books++;
+        stats.authorBytes += copyBytes(*book->author);
+        if (book->isbn.isPacked()) stats.packedIsbns++;
+    }
+    for (Node* child : node->children) fieldStats(child, stats);
+}
+
+// Helper function to print one interned field as a row of the memstats table
+static void printInternStats(const string& name, StringPool& pool, long long handles, long long copies)
+{
+    long long tables = pool.tableBytes(); // Fixed cost of the shards, larger than the saving on a small catalog
+    long long held = handles * sizeof(const string*) + pool.bytes() - tables; // Handles plus the pool's single copies
+    cout << left << setw(16) << name << right << setw(10) << pool.size() << setw(12) << handles << setw(14) << copies
+         << setw(14) << held << setw(14) << tables << setw(14) << copies - held - tables << endl;
+}
+
+// Method to display the allocation counters of the catalog's object pools
+void LCMS :: memstats()
+{
+    ensureWritable(); // The counters describe the catalog in memory
+    cout << left << setw(12) << "pool" << right << setw(12) << "live" << setw(12) << "created"
+         << setw(12) << "recycled" << setw(10) << "slabs" << setw(14) << "slab bytes" << endl;
+    printPoolStats("nodes", libTree->getNodePool());
+    printPoolStats("books", libTree->getBookPool());
+    printPoolStats("borrowers", borrowerPool);
+    long long objects = libTree->getNodePool().live() + libTree->getBookPool().live() + borrowerPool.live();
+    long long slabs = libTree->getNodePool().slabsHeld() + libTree->getBookPool().slabsHeld() + borrowerPool.slabsHeld();
+    cout << objects << " objects live in " << slabs << " slab allocations" << endl;
+
+    // Per-book and per-borrower lists keep their first elements inline, only the long ones allocate
+    long long lists, spilled, heapBytes;
+    cout << endl << left << setw(20) << "list" << right << setw(12) << "lists" << setw(12) << "spilled"
+         << setw(14) << "heap bytes" << endl;
+    loans.historyStats(lists, spilled, heapBytes);
+    printListStats("book histories", lists, spilled, heapBytes);
+    loans.listStats(true, lists, spilled, heapBytes);
+    printListStats("loans by book", lists, spilled, heapBytes);
+    loans.listStats(false, lists, spilled, heapBytes);
+    printListStats("loans by borrower", lists, spilled, heapBytes);
+
+    // Authors and category names are interned, each distinct string is stored once
+    FieldStats fields = { 0, 0, 0, 0, 0 };
+    fieldStats(libTree->getRoot(), fields);
+    cout << endl << left << setw(16) << "interned" << right << setw(10) << "distinct" << setw(12) << "handles"
+         << setw(14) << "as copies" << setw(14) << "interned" << setw(14) << "pool tables" << setw(14) << "net saved" << endl;
+    printInternStats("authors", Book::authors, fields.books, fields.authorBytes);
+    printInternStats("category names", Node::names, fields.nodes, fields.nameBytes);
+
+    // The compact book record: titles in an arena, ISBNs packed into the record when they are bare digits
+    TextArena& titles = libTree->getTitleArena();
+    cout << endl << "book record: " << sizeof(Book) << " bytes" << endl;
+    cout << "titles: " << titles.live() << " bytes live, " << titles.dead() << " bytes dead in "
+         << titles.chunksHeld() << " chunks (" << titles.bytes() << " bytes)" << endl;
+    cout << "ISBNs: " << fields.packedIsbns << " packed, " << fields.books - fields.packedIsbns << " formatted ("
+         << Isbn::pool().size() << " distinct, " << Isbn::pool().bytes() << " bytes)" << endl;
+    const FlatTree& flat = libTree->layout(); // Built by the first subtree scan, kept until the tree changes
+    cout << "flat layout: " << flat.size() << " nodes, " << flat.subtreeBooks(0) << " books (" << flat.bytes() << " bytes)" << endl;
+    cout << "ISBN index: " << isbnIndex.size() << " ISBNs, author index: " << authorIndex.size() << " authors, year index: " << yearIndex.size() << " years" << endl;
+    cout << "text index: " << textIndex.terms() << " words, " << textIndex.size() << " books (" << textIndex.bytes() << " bytes)" << endl;
+
+    long pages = 0, residentPages = 0;
+    ifstream statm("/proc/self/statm"); // Linux only, the line is skipped elsewhere
+    if (statm >> pages >> residentPages)
+    {
+        cout << "resident size: " << residentPages * (sysconf(_SC_PAGESIZE) / 1024) << " KB" << endl;
+    }
+}
+
 // Method to display the catalog in a tree format
 void LCMS :: list()                   
 {
+    if (view != nullptr) { view->list(); return; } // Answer from the mapped snapshot
     libTree->print(); // Call the print method of the library tree to display the catalog
 }
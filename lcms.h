@@ -9,16 +9,42 @@
 #ifndef _LCMS_H
 #define _LCMS_H
 #include<string>
+#include<map>
+#include<unordered_map>
+#include<stdint.h>
 #include "tree.h"
 #include "myvector.h"
+#include "pool.h"
 #include "borrower.h"
+#include "loan.h"
+#include "catalogview.h"
+#include "journal.h"
+#include "textindex.h"
 //#include "book.h"
 
+struct SnapshotBuilder;
+struct FieldStats;
+
 class LCMS
 {
 	private:
 		Tree *libTree;	//Tree of Categories and books
 		MyVector<Borrower*> borrowers; //list of borrowers that have ever borrowed a book	
+		Pool<Borrower> borrowerPool;	//allocator of the borrowers, frees them all at once
+		typedef SmallVector<Book*, 1> TitleBucket;	//books carrying one title, most titles have one
+		unordered_map<TextRef, TitleBucket, TextRefHash> titleIndex; //catalog-wide index from title to the books carrying it, keyed by a title in the arena
+		typedef SmallVector<Book*, 1> IsbnBucket;	//books carrying one ISBN, most ISBNs have one
+		unordered_map<uint64_t, IsbnBucket> isbnIndex;	//index from the ISBN-13 digits of a book's ISBN, whatever form it was entered in, to the books carrying it
+		typedef MyVector<Book*> BookGroup;	//books sharing an author or a year, in no particular order
+		unordered_map<const string*, BookGroup> authorIndex;	//index from an interned author to the books by them
+		map<int, BookGroup> yearIndex;	//ordered index from a publication year to the books published that year, walked for year ranges
+		TextIndex textIndex;	//catalog-wide index from the words of titles and authors, and the trigrams of titles, to the books having them
+		unordered_map<string, Borrower*> borrowerIndex; //registry from (name, id) to the single Borrower object of a patron
+		LoanTable loans;	//active loans, the only record of who currently holds which book
+		int workerThreads;	//number of threads used by bulk operations
+		CatalogView* view;	//read-only snapshot answering queries in place of libTree, nullptr when the catalog is in memory
+		Journal* journal;	//write-ahead journal of every change, nullptr when the catalog is not journaled
+		string journalBase;	//path of the journal and its checkpoint without their extensions
 	public:
 		LCMS(string name);
 		~LCMS();
@@ -27,6 +53,11 @@ class LCMS
 		void exportData(string path); //export all books to a given file
 		void findAll(string category); //display all books of a category
 		void findBook(string bookTitle); //Find a given book and display its details
+		void search(string terms);	//display the books whose title or author has every word of a query, OR between alternatives
+		void fuzzyFind(string text);	//display the books whose title is closest to a text, typing errors allowed
+		void findByIsbn(string isbn);	//display the books with an ISBN, ISBN-10 and ISBN-13 alike, hyphens or not
+		void findByAuthor(string author);	//display the books by an author, written exactly as in the catalog
+		void findByYear(string range);	//display the books published in a range of years, optionally only those of a category
 		void addBook();	//add a book to the catalog
 		void editBook(string bookTitle); //edit a book
 		void borrowBook(string bookTitle); //borrow a book
@@ -40,9 +71,53 @@ class LCMS
 		void removeCategory(string category); //remove a category from the catalog
 		void editCategory(string category); //edit a category from the catalog
 		void list();			   //display the catalog in tree format by calling the print method of the libTree
-		Book* find_book_helper(Node* node, Tree* tree, const string& title);
-		bool removeBookHelper(Node* node, const string& bookTitle) ;
-		int export_helper(Node* node, ofstream& file);
+		void setThreads(string count);	//show or set the number of threads used by bulk operations
+		void save(string path);			//write the whole catalog, borrowers and loans to a binary snapshot
+		void load(string path);			//replace the whole catalog with the content of a binary snapshot
+		void openReadOnly(string path);	//serve queries straight from a mapped snapshot until something has to change
+		void openJournal(string base);	//load <base>.snap, replay <base>.journal and journal every change from now on
+		void checkpoint();				//write <base>.snap and empty the journal
+		void memstats();				//display the allocation counters of the object pools and the memory of the per-entity lists
+
+	private:
+		Book* lookupBook(const string& title);	//return the first book carrying a title in pre-order, nullptr if none
+		Book* findInCategory(Node* node, const TextRef& title);	//return the book with a title in a given category, nullptr if none
+		void indexBook(Book* book);				//add a book to the title and text indices
+		void unindexBook(Book* book);			//remove a book from the title and text indices
+		void indexGroups(Book* book);			//add a book to the ISBN, author and year indices
+		void unindexGroups(Book* book);			//remove a book from the ISBN, author and year indices
+		void indexIsbn(Book* book);				//add a book to the ISBN index
+		void unindexIsbn(Book* book);			//remove a book from the ISBN index
+		void indexAuthor(Book* book);			//add a book to the author index
+		void unindexAuthor(Book* book);			//remove a book from the author index
+		void indexYear(Book* book);				//add a book to the year index
+		void unindexYear(Book* book);			//remove a book from the year index
+		template <typename Index, typename Key>
+		static void leaveGroup(Index& index, const Key& key, Book* book);	//remove a book from its group of the ISBN, author or year index
+		template <typename Index, typename Key>
+		static void leaveGroups(Index& index, MyVector<Key>& keys, uint32_t begin, uint32_t end);	//remove the books of the nodes [begin, end) of the flat layout from the groups of some keys
+		static bool titleOrder(Book* a, Book* b);	//true if a comes before b by title, then by category path
+		void dropBook(Book* book);				//forget every index entry and loan of a book that is about to be freed
+		void dropSubtree(Node* node);			//dropBook every book of a node and its children
+		void ensureWritable();					//load the read-only snapshot into memory before a command that needs the objects
+		uint64_t loadSnapshot(const string& path);	//replace the catalog with a snapshot, return the last journal record it includes
+		void writeSnapshot(const string& path, uint64_t sequence);	//write a snapshot including the journal up to a record
+		Book* addBookTo(const string& category, const string& title, const string& author, const string& isbn,
+		                int publn_year, int total_copies, int available_copies);	//add a book unless its category has the title, nullptr if it does
+		void setBookField(Book* book, int field, const string& value);	//set a field of a book, numbered as in the editBook menu
+		bool checkoutBook(Book* book, const string& name, const string& id);	//lend a copy, false if the patron already holds one
+		bool checkinBook(Book* book, const string& name, const string& id);	//take a copy back, false if the patron holds none
+		JournalRecord addRecord(const string& category, Book* book);	//journal record adding a book
+		JournalRecord bookRecord(JournalOp op, Book* book);		//journal record about a book, named by category and position
+		Book* journalBook(JournalRecord& record);				//the book a journal record names
+		void journalLog(JournalRecord& record);					//append a record and wait until it is durable
+		void journalCommit(uint64_t sequence);					//wait until the records of a batch are durable
+		void applyRecord(JournalRecord& record);				//replay one record
+		void clear(Tree* tree);					//free the catalog, borrowers and loans, and start over with a given tree
+		void save_helper(Node* node, uint32_t parent, uint32_t depth, SnapshotBuilder& out);	//append a subtree to a snapshot in pre-order
+		Borrower* findBorrower(const string& name, const string& id);	//return the registered borrower, nullptr if none
+		Borrower* registerBorrower(const string& name, const string& id);	//return the registered borrower, creating it on first use
+		void fieldStats(Node* node, FieldStats& stats);	//add up how the nodes and books of a subtree store their fields
 		
 };
 #endif
\ No newline at end of file
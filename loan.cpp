@@ -0,0 +1,236 @@
+//============================================================================
+// Name         : loan.cpp
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : 
+//============================================================================
+#include "loan.h" // Include the header file for the LoanTable class
+#include <functional>
+
+// Hash of a (borrower, book) pair, combining both pointer hashes
+size_t LoanTable::LoanKeyHash::operator()(const LoanKey& key) const
+{
+    size_t h = hash<Borrower*>()(key.borrower);
+    return h ^ (hash<Book*>()(key.book) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+// Method to check whether a borrower currently holds a copy of a book
+bool LoanTable::contains(Borrower* borrower, Book* book) const
+{
+    LoanKey key = { borrower, book };
+    return pairIndex.find(key) != pairIndex.end(); // One probe in the pair index
+}
+
+// Method to record a new loan
+void LoanTable::checkout(Borrower* borrower, Book* book)
+{
+    LoanKey key = { borrower, book };
+    if (pairIndex.find(key) != pairIndex.end())
+    {
+        throw runtime_error("Loan already exists"); // A borrower holds at most one copy of a book
+    }
+
+    LoanList& bookLoans = byBook[book]; // Loans of the book
+    LoanList& borrowerLoans = byBorrower[borrower]; // Loans of the borrower
+
+    Loan loan;
+    loan.borrower = borrower;
+    loan.book = book;
+    loan.bookSlot = bookLoans.size(); // The new loan goes at the end of both lists
+    loan.borrowerSlot = borrowerLoans.size();
+
+    int index = loans.size();
+    loans.push_back(loan); // Store the loan once
+    bookLoans.push_back(index); // Index it by book
+    borrowerLoans.push_back(index); // Index it by borrower
+    pairIndex[key] = index; // Index it by pair
+}
+
+// Helper method to swap-remove a loan position from a per-book or per-borrower list
+void LoanTable::unlink(LoanList& list, int slot, bool bookSide)
+{
+    int last = list.size() - 1;
+    if (slot != last)
+    {
+        list[slot] = list[last]; // Move the last position into the hole
+        if (bookSide) loans[list[slot]].bookSlot = slot; // Tell the moved loan where it now lives
+        else          loans[list[slot]].borrowerSlot = slot;
+    }
+    list.erase(last); // Erasing the last element does not shift anything
+}
+
+// Helper method to swap-remove a loan record
+void LoanTable::removeAt(int index)
+{
+    Loan loan = loans[index];
+    LoanKey key = { loan.borrower, loan.book };
+    pairIndex.erase(key);
+
+    // Drop the loan from the per-book list, and the list itself once it is empty
+    unordered_map<Book*, LoanList>::iterator bookIt = byBook.find(loan.book);
+    unlink(bookIt->second, loan.bookSlot, true);
+    if (bookIt->second.empty()) byBook.erase(bookIt);
+
+    // Drop the loan from the per-borrower list, and the list itself once it is empty
+    unordered_map<Borrower*, LoanList>::iterator borrowerIt = byBorrower.find(loan.borrower);
+    unlink(borrowerIt->second, loan.borrowerSlot, false);
+    if (borrowerIt->second.empty()) byBorrower.erase(borrowerIt);
+
+    int last = loans.size() - 1;
+    if (index != last)
+    {
+        // Move the last record into the hole and repoint the three indices that referenced it
+        Loan moved = loans[last];
+        loans[index] = moved;
+        byBook[moved.book][moved.bookSlot] = index;
+        byBorrower[moved.borrower][moved.borrowerSlot] = index;
+        LoanKey movedKey = { moved.borrower, moved.book };
+        pairIndex[movedKey] = index;
+    }
+    loans.erase(last);
+}
+
+// Method to remove a loan when a book is returned
+bool LoanTable::checkin(Borrower* borrower, Book* book)
+{
+    LoanKey key = { borrower, book };
+    unordered_map<LoanKey, int, LoanKeyHash>::iterator it = pairIndex.find(key);
+    if (it == pairIndex.end())
+    {
+        return false; // The borrower does not hold this book
+    }
+    removeAt(it->second);
+    return true;
+}
+
+// Method to drop every loan and the history of a book that is being removed from the catalog
+void LoanTable::removeBook(Book* book)
+{
+    unordered_map<Book*, LoanList>::iterator it = byBook.find(book);
+    while (it != byBook.end())
+    {
+        removeAt(it->second[it->second.size() - 1]); // The list is erased with its last loan
+        it = byBook.find(book);
+    }
+    histories.erase(book); // The book's slot may be reused by a new book
+}
+
+// Method to add a borrower to the history of a book
+bool LoanTable::addHistory(Book* book, Borrower* borrower)
+{
+    History& history = histories[book]; // Created on the book's first checkout
+    for (Borrower* known : history)
+    {
+        if (known == borrower) return false; // Borrowed the book before
+    }
+    history.push_back(borrower);
+    return true;
+}
+
+// Method to count the borrowers a book ever had
+int LoanTable::historyCount(Book* book) const
+{
+    unordered_map<Book*, History>::const_iterator it = histories.find(book);
+    return (it == histories.end()) ? 0 : it->second.size();
+}
+
+// Method to get the index-th borrower in the history of a book
+Borrower* LoanTable::historyAt(Book* book, int index)
+{
+    unordered_map<Book*, History>::iterator it = histories.find(book);
+    if (it == histories.end() || index < 0 || index >= it->second.size())
+    {
+        throw out_of_range("History index out of range");
+    }
+    return it->second[index];
+}
+
+// Method to count the current borrowers of a book
+int LoanTable::countByBook(Book* book) const
+{
+    unordered_map<Book*, LoanList>::const_iterator it = byBook.find(book);
+    return (it == byBook.end()) ? 0 : it->second.size();
+}
+
+// Method to get the index-th current borrower of a book
+Borrower* LoanTable::borrowerAt(Book* book, int index)
+{
+    unordered_map<Book*, LoanList>::iterator it = byBook.find(book);
+    if (it == byBook.end() || index < 0 || index >= it->second.size())
+    {
+        throw out_of_range("Loan index out of range");
+    }
+    return loans[it->second[index]].borrower;
+}
+
+// Method to count the books currently held by a borrower
+int LoanTable::countByBorrower(Borrower* borrower) const
+{
+    unordered_map<Borrower*, LoanList>::const_iterator it = byBorrower.find(borrower);
+    return (it == byBorrower.end()) ? 0 : it->second.size();
+}
+
+// Method to get the index-th book currently held by a borrower
+Book* LoanTable::bookAt(Borrower* borrower, int index)
+{
+    unordered_map<Borrower*, LoanList>::iterator it = byBorrower.find(borrower);
+    if (it == byBorrower.end() || index < 0 || index >= it->second.size())
+    {
+        throw out_of_range("Loan index out of range");
+    }
+    return loans[it->second[index]].book;
+}
+
+// Method to get the number of active loans
+int LoanTable::size() const
+{
+    return loans.size();
+}
+
+// Method to count the per-book (or per-borrower) lists, how many outgrew their inline slots and the heap they use
+void LoanTable::listStats(bool bookSide, long long& lists, long long& spilled, long long& heapBytes) const
+{
+    lists = spilled = heapBytes = 0;
+    if (bookSide)
+    {
+        for (unordered_map<Book*, LoanList>::const_iterator it = byBook.begin(); it != byBook.end(); ++it)
+        {
+            lists++;
+            if (!it->second.isInline()) spilled++;
+            heapBytes += it->second.heapBytes();
+        }
+    }
+    else
+    {
+        for (unordered_map<Borrower*, LoanList>::const_iterator it = byBorrower.begin(); it != byBorrower.end(); ++it)
+        {
+            lists++;
+            if (!it->second.isInline()) spilled++;
+            heapBytes += it->second.heapBytes();
+        }
+    }
+}
+
+// Method to count the borrower histories, how many outgrew their inline slots and the heap they use
+void LoanTable::historyStats(long long& lists, long long& spilled, long long& heapBytes) const
+{
+    lists = spilled = heapBytes = 0;
+    for (unordered_map<Book*, History>::const_iterator it = histories.begin(); it != histories.end(); ++it)
+    {
+        lists++;
+        if (!it->second.isInline()) spilled++;
+        heapBytes += it->second.heapBytes();
+    }
+}
+
+// Method to drop every loan and every history, used when the whole catalog is replaced
+void LoanTable::clear()
+{
+    loans.clear();
+    pairIndex.clear();
+    byBook.clear();
+    byBorrower.clear();
+    histories.clear();
+}
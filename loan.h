@@ -0,0 +1,68 @@
+//============================================================================
+// Name         : loan.h
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Table of active loans (borrower, book) with hash indices, and borrower histories
+//============================================================================
+#ifndef _LOAN_H
+#define _LOAN_H
+#include<cstddef>
+#include<unordered_map>
+#include "myvector.h"
+#include "smallvector.h"
+class Book;
+class Borrower;
+
+class LoanTable
+{
+	private:
+		struct Loan
+		{
+			Borrower* borrower;		//patron holding the copy
+			Book* book;				//book the copy belongs to
+			int bookSlot;			//position of this loan in the book's list
+			int borrowerSlot;		//position of this loan in the borrower's list
+		};
+		struct LoanKey
+		{
+			Borrower* borrower;
+			Book* book;
+			bool operator==(const LoanKey& other) const { return borrower == other.borrower && book == other.book; }
+		};
+		struct LoanKeyHash
+		{
+			size_t operator()(const LoanKey& key) const;
+		};
+
+		typedef SmallVector<int, 3> LoanList;				//positions of one book's or one borrower's loans, inline up to three
+		typedef SmallVector<Borrower*, 2> History;			//everyone who ever borrowed a book, inline up to two
+
+		MyVector<Loan> loans;								//one record per active loan
+		unordered_map<LoanKey, int, LoanKeyHash> pairIndex;	//(borrower, book) -> position in loans
+		unordered_map<Book*, LoanList> byBook;				//book -> positions of its loans
+		unordered_map<Borrower*, LoanList> byBorrower;		//borrower -> positions of their loans
+		unordered_map<Book*, History> histories;			//book -> its borrowers so far, only for books that circulated
+
+		void unlink(LoanList& list, int slot, bool bookSide);	//swap-remove a position from a per-book/per-borrower list
+		void removeAt(int index);									//swap-remove a loan record and fix every index pointing at the moved one
+
+	public:
+		bool contains(Borrower* borrower, Book* book) const;	//return true if the borrower currently holds a copy of the book
+		void checkout(Borrower* borrower, Book* book);			//record a new loan, the pair must not be on loan already
+		bool checkin(Borrower* borrower, Book* book);			//remove a loan, returns false if the pair is not on loan
+		void removeBook(Book* book);							//drop every loan and the history of a book that is leaving the catalog
+		bool addHistory(Book* book, Borrower* borrower);		//add a borrower to a book's history, false if already there
+		int historyCount(Book* book) const;						//number of borrowers a book ever had
+		Borrower* historyAt(Book* book, int index);				//index-th borrower in a book's history
+		int countByBook(Book* book) const;						//number of current borrowers of a book
+		Borrower* borrowerAt(Book* book, int index);			//index-th current borrower of a book
+		int countByBorrower(Borrower* borrower) const;			//number of books currently held by a borrower
+		Book* bookAt(Borrower* borrower, int index);			//index-th book currently held by a borrower
+		int size() const;										//number of active loans
+		void listStats(bool bookSide, long long& lists, long long& spilled, long long& heapBytes) const;	//count the per-book or per-borrower lists and their heap use
+		void historyStats(long long& lists, long long& spilled, long long& heapBytes) const;	//count the borrower histories and their heap use
+		void clear();											//drop every loan and every history
+};
+#endif
@@ -12,10 +12,22 @@ using namespace std;
 
 void listCommands();
 
-int main()
+int main(int argc, char* argv[])
 {
 	LCMS lcms("Library");
 	listCommands();
+	if (argc > 1) // lcms <catalog>: keep the catalog durable in <catalog>.snap and <catalog>.journal
+	{
+		try
+		{
+			lcms.openJournal(argv[1]);
+		}
+		catch(exception &ex)
+		{
+			cout<<ex.what()<<endl;
+			return EXIT_FAILURE;
+		}
+	}
 	do
 	{
 		string user_input="";
@@ -38,6 +50,11 @@ int main()
 			else if(command=="list")			lcms.list();
 			else if(command=="findAll")     	lcms.findAll(parameter);
 			else if(command=="findBook")		lcms.findBook(parameter);
+			else if(command=="search")			lcms.search(parameter);
+			else if(command=="fuzzyFind")		lcms.fuzzyFind(parameter);
+			else if(command=="findByIsbn")		lcms.findByIsbn(parameter);
+			else if(command=="findByAuthor")	lcms.findByAuthor(parameter);
+			else if(command=="findByYear")		lcms.findByYear(parameter);
 			else if(command=="addBook") 		lcms.addBook();
 			else if(command=="editBook")		lcms.editBook(parameter);
 			else if(command=="borrowBook")      lcms.borrowBook(parameter);
@@ -49,6 +66,12 @@ int main()
 			else if(command=="findCategory")    lcms.findCategory(parameter);
 			else if(command=="addCategory")    lcms.addCategory(parameter);
 			else if(command=="removeCategory")  lcms.removeCategory(parameter);
+			else if(command=="threads")         lcms.setThreads(parameter);
+			else if(command=="save")            lcms.save(parameter);
+			else if(command=="load")            lcms.load(parameter);
+			else if(command=="openReadOnly")    lcms.openReadOnly(parameter);
+			else if(command=="checkpoint")      lcms.checkpoint();
+			else if(command=="memstats")        lcms.memstats();
 			else if(command == "help")			listCommands();
 			else if(command == "exit")			break;
 			else 								cout<<"Invalid Command!"<<endl;
@@ -72,6 +95,11 @@ void listCommands()
 		<<" export <file_name>                          : Export Books to a file"<<endl
 		<<" findBook <title of the book>                : Search a book in the catalog"<<endl
 		<<" findAll <category/sub-category/..>          : List all books in a category/sub-category"<<endl
+		<<" search <words> [OR <words> ...]             : List the books whose title or author has all the words"<<endl
+		<<" fuzzyFind <title of the book>               : List the closest titles, allowing for typing errors"<<endl
+		<<" findByIsbn <ISBN-10 or ISBN-13>             : Search a book by ISBN, with or without hyphens"<<endl
+		<<" findByAuthor <author(s) of the book>        : List all books by an author, as written in the catalog"<<endl
+		<<" findByYear <from>-<to> [category]           : List the books published in a range of years, in a category or all"<<endl
 		<<" addBook                                     : Add a book to the Catalog"<<endl
 		<<" editBook <title of the book>                : Edit a book detail in the catalog"<<endl
 		<<" removeBook <title of the book>              : Remove a book from the Catalog"<<endl
@@ -85,6 +113,12 @@ void listCommands()
 		<<" removeCategory <category/sub-category/...>  : Remove a category/sub-category from the catalog"<<endl
 		//<<" editCategory <category/sub-category/...>    : Edit a category/sub-category"<<endl
 		<<" list                                        : Display all categories from the catalog"<<endl
+		<<" threads [count]                             : Show or set the number of threads used by import, findAll and export"<<endl
+		<<" save <file_name>                            : Save the catalog, borrowers and loans to a binary snapshot"<<endl
+		<<" load <file_name>                            : Replace the catalog with a binary snapshot"<<endl
+		<<" openReadOnly <file_name>                    : Answer queries straight from a snapshot, loading it on the first change"<<endl
+		<<" checkpoint                                  : Snapshot a journaled catalog (lcms <catalog>) and empty its journal"<<endl
+		<<" memstats                                    : Display the allocation counters and list memory of the catalog"<<endl
 		<<" help                                        : Display the list of available commands"<<endl
 		<<" exit                                        : Exit the Program"<<endl
 		<<" ====================================================================================\n"<<endl;	
@@ -0,0 +1,70 @@
+//============================================================================
+// Name         : mappedfile.cpp
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : 
+//============================================================================
+#include "mappedfile.h" // Include the header file for the MappedFile class
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+// Constructor: open the file and map it read-only into memory
+MappedFile::MappedFile(const string& path)
+{
+    this->bytes = nullptr;
+    this->length = 0;
+
+    int fd = open(path.c_str(), O_RDONLY); // Open the file for reading
+    if (fd < 0)
+    {
+        throw runtime_error("Couldn't open the file"); // Throw an exception if the file cannot be opened
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        close(fd);
+        throw runtime_error("Couldn't open the file"); // Only regular files can be mapped
+    }
+
+    this->length = info.st_size;
+    if (this->length > 0) // mmap rejects empty mappings, an empty file simply has no bytes
+    {
+        void* mapping = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close(fd);
+            throw runtime_error("Couldn't map the file");
+        }
+        madvise(mapping, this->length, MADV_SEQUENTIAL); // Importers read front to back, let the kernel read ahead
+        this->bytes = static_cast<const char*>(mapping);
+    }
+    close(fd); // The mapping stays valid after the descriptor is closed
+}
+
+// Destructor: release the mapping
+MappedFile::~MappedFile()
+{
+    if (this->bytes != nullptr)
+    {
+        munmap(const_cast<char*>(this->bytes), this->length);
+    }
+}
+
+// Method to get the first byte of the file
+const char* MappedFile::data() const
+{
+    return this->bytes;
+}
+
+// Method to get the size of the file
+size_t MappedFile::size() const
+{
+    return this->length;
+}
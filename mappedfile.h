@@ -0,0 +1,29 @@
+//============================================================================
+// Name         : mappedfile.h
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Read-only memory mapping of a whole file
+//============================================================================
+#ifndef _MAPPEDFILE_H
+#define _MAPPEDFILE_H
+#include<cstddef>
+#include<string>
+
+class MappedFile
+{
+	private:
+		const char* bytes;		//start of the mapping, nullptr for an empty file
+		size_t length;			//size of the file in bytes
+
+		MappedFile(const MappedFile&);				//not copyable, the mapping has a single owner
+		MappedFile& operator=(const MappedFile&);
+
+	public:
+		MappedFile(const std::string& path);	//map the file, throws runtime_error if it cannot be opened
+		~MappedFile();							//unmap the file
+		const char* data() const;				//first byte of the file
+		size_t size() const;					//number of bytes in the file
+};
+#endif
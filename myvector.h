@@ -13,31 +13,58 @@
 #include<iomanip>
 #include <stdexcept>
 #include<sstream>
+#include<cstring>
+#include<new>
+#include<utility>
+#include<type_traits>
 
 using namespace std;
 template <typename T>
 class MyVector
 {
 	private:
-		T *data;						//pointer to int(array) to store elements
+		T *data;						//storage for v_capacity elements, only the first v_size are constructed
 		int v_size;						//current size of vector (number of elements in vector)
 		int v_capacity;					//capacity of vector
+
+		// Elements that are trivially copyable (pointers, ints, plain records) are moved with
+		// memcpy/memmove and grown with realloc; other types are move-constructed one by one
+		static const bool TRIVIAL = is_trivially_copyable<T>::value;
+		void reallocate(int cap);		//move the elements to storage for cap elements
+		void grow();					//make room for one more element
+		void destroyAll();				//destroy the elements, keeping the storage
 	public:
+		typedef T* iterator;
+		typedef const T* const_iterator;
+
 		MyVector();						//No argument constructor
-		MyVector(int cap);				//One Argument Constructor
+		MyVector(int cap);				//One Argument Constructor, reserves cap elements
 		MyVector(const MyVector& other);		//Copy Constructor
+		MyVector(MyVector&& other) noexcept;	//Move Constructor, steals the storage of other
+		MyVector& operator=(const MyVector& other);	//Copy Assignment
+		MyVector& operator=(MyVector&& other) noexcept;	//Move Assignment
 		~MyVector();					//Destructor
-		void push_back(T element);		//Add an element at the end of vector
+		void push_back(const T& element);	//Add a copy of an element at the end of vector
+		void push_back(T&& element);	//Move an element to the end of vector
+		template <typename... Args>
+		T& emplace_back(Args&&... args);	//Construct an element in place at the end of vector
 		void insert(int index, T element); //Add an element at the index 
 		void erase(int index);			//Removes an element from the index
 		T& operator[](int index);		//return reference of the element at index
+		const T& operator[](int index) const;
 		T& at(int index); 				//return reference of the element at index
 		const T& front();				//Returns reference of the first element in the vector
 		const T& back();				//Returns reference of the Last element in the vector
 		int size() const;				//Return current size of vector
 		int capacity() const;			//Return capacity of vector
 		bool empty() const; 			//Return true if the vector is empty, False otherwise
+		void reserve(int cap);			//Make room for at least cap elements
 		void shrink_to_fit();			//Reduce vector capacity to fit its size
+		void clear();					//Remove all elements, keeping the capacity
+		iterator begin();				//First element, for range-based for
+		iterator end();					//One past the last element
+		const_iterator begin() const;
+		const_iterator end() const;
 };
 //========================================
 
@@ -63,25 +90,125 @@ MyVector<T>::MyVector()
 template <typename T>
 MyVector<T>::MyVector(int cap)
 {
-    this->v_capacity = cap;
+    data = nullptr;
+    this->v_capacity = 0;
     this->v_size = 0;
-    data = new T[v_capacity];
+    reserve(cap);
 }
 //========================================
 template <typename T>
 MyVector<T>::MyVector(const MyVector &other)
 {
-    this->v_capacity = other.v_capacity;
+    data = nullptr;
+    this->v_capacity = 0;
+    this->v_size = 0;
+    reserve(other.v_size); // Only the elements are copied, not the unused capacity
+    if (TRIVIAL)
+    {
+        if (other.v_size > 0) memcpy(static_cast<void*>(data), other.data, other.v_size * sizeof(T));
+    }
+    else
+    {
+        for (int i = 0; i < other.v_size; i++)
+            new (&data[i]) T(other.data[i]);
+    }
+    this->v_size = other.v_size;
+}
+//========================================
+template <typename T>
+MyVector<T>::MyVector(MyVector &&other) noexcept
+{
+    this->data = other.data;
     this->v_size = other.v_size;
-    this->data = new T [v_capacity];
-    for(int i=0; i<v_capacity; i++)
-        this->data[i] = other.data[i];
+    this->v_capacity = other.v_capacity;
+    other.data = nullptr; // other is left empty
+    other.v_size = 0;
+    other.v_capacity = 0;
+}
+//========================================
+template <typename T>
+MyVector<T>& MyVector<T>::operator=(const MyVector &other)
+{
+    if (this != &other)
+    {
+        MyVector<T> copy(other); // Copy first, so a failed copy leaves this vector unchanged
+        *this = std::move(copy);
+    }
+    return *this;
+}
+//========================================
+template <typename T>
+MyVector<T>& MyVector<T>::operator=(MyVector &&other) noexcept
+{
+    if (this != &other)
+    {
+        destroyAll();
+        free(this->data);
+        this->data = other.data;
+        this->v_size = other.v_size;
+        this->v_capacity = other.v_capacity;
+        other.data = nullptr; // other is left empty
+        other.v_size = 0;
+        other.v_capacity = 0;
+    }
+    return *this;
 }
 //========================================
 template <typename T>
 MyVector<T>::~MyVector()
 {
-    delete [] this->data;
+    destroyAll();
+    free(this->data);
+}
+//========================================
+template <typename T>
+void MyVector<T>::destroyAll()
+{
+    if (!TRIVIAL)
+    {
+        for (int i = 0; i < v_size; i++)
+            data[i].~T();
+    }
+    v_size = 0;
+}
+//========================================
+template <typename T>
+void MyVector<T>::reallocate(int cap)
+{
+    if (TRIVIAL) // The bytes are the elements: let realloc grow in place when it can
+    {
+        void* grown = realloc(static_cast<void*>(data), (size_t)(cap > 0 ? cap : 1) * sizeof(T));
+        if (grown == nullptr) throw bad_alloc();
+        data = static_cast<T*>(grown);
+    }
+    else
+    {
+        T* temp = static_cast<T*>(malloc((size_t)(cap > 0 ? cap : 1) * sizeof(T)));
+        if (temp == nullptr) throw bad_alloc();
+        for (int i = 0; i < v_size; i++) // Move elements to the new storage
+        {
+            new (&temp[i]) T(std::move(data[i]));
+            data[i].~T();
+        }
+        free(data); // Deallocate memory for current array
+        data = temp; // Update data pointer
+    }
+    v_capacity = cap;
+}
+//========================================
+template <typename T>
+void MyVector<T>::grow()
+{
+    if (v_size == v_capacity) // Check if vector is full
+    {
+        reallocate(v_capacity == 0 ? 1 : v_capacity * 2); // Double vector capacity
+    }
+}
+//========================================
+template <typename T>
+void MyVector<T>::reserve(int cap)
+{
+    if (cap > v_capacity) reallocate(cap);
 }
 //========================================
 template <typename T>
@@ -103,38 +230,43 @@ bool MyVector<T>::empty() const
 }
 //========================================
 template <typename T>
-void MyVector<T>::push_back(T element)
+void MyVector<T>::push_back(const T& element)
 {
-    if (v_size == v_capacity) // Check if vector is full
+    if (v_size == v_capacity && &element >= data && &element < data + v_size) // The element lives in this vector
     {
-        if (v_capacity == 0) // If capacity is 0
-        {
-            data = new T[1]; // Create a new element
-            data[0] = element;
-            v_size++; // Increment vector size
-            v_capacity++; // Increment vector capacity
-        }
-        else // If capacity is not 0
-        {
-            T* temp = new T[v_capacity * 2]; // Create temporary array with doubled capacity
-            
-            for (int i = 0; i < v_size; i++) // Copy elements to temporary array
-            {
-                temp[i] = data[i];
-            }
-            
-            delete [] data; // Deallocate memory for current array
-            data = temp; // Update data pointer
-            data[v_size] = element; // Add new element
-            v_size++; // Increment vector size
-            v_capacity = v_capacity * 2; // Double vector capacity
-        }
+        T copy(element); // Growing would free it, copy it out first
+        grow();
+        new (&data[v_size]) T(std::move(copy));
     }
-    else // If vector has space
+    else
     {
-        data[v_size] = element; // Add element to vector
-        v_size++; // Increment vector size
+        grow();
+        new (&data[v_size]) T(element); // Add element to vector
+    }
+    v_size++; // Increment vector size
+}
+//========================================
+template <typename T>
+void MyVector<T>::push_back(T&& element)
+{
+    emplace_back(std::move(element));
+}
+//========================================
+template <typename T>
+template <typename... Args>
+T& MyVector<T>::emplace_back(Args&&... args)
+{
+    if (v_size == v_capacity)
+    {
+        T element(std::forward<Args>(args)...); // The arguments may refer to elements that growing moves
+        grow();
+        new (&data[v_size]) T(std::move(element));
+    }
+    else
+    {
+        new (&data[v_size]) T(std::forward<Args>(args)...); // Construct the element in place
     }
+    return data[v_size++];
 }
 //===============================================================================
 template <typename T>	
@@ -146,45 +278,22 @@ void MyVector<T>::insert(int index,T element)
     }
     else
     {
-        if (v_size == v_capacity) // Check if vector is full
+        grow();
+        if (TRIVIAL)
         {
-            T* temp = new T[v_capacity * 2]; // Create temporary array with doubled capacity
-            
-            for (int i = 0; i <= v_size; i++) // Copy elements to temporary array
-            {
-                if (index == i) // Insert element at specified index
-                {
-                    temp[i] = element;
-                }
-                else if (index > i) // Copy elements before index
-                {
-                    temp[i] = data[i];
-                }
-                else // Copy elements after index and shift right
-                {
-                    temp[i] = data[i - 1];
-                }
-            }
-            
-            delete [] data; // Deallocate memory for current array
-            data = temp; // Update data pointer
-            v_size++; // Increment vector size
-            v_capacity = v_capacity * 2; // Double vector capacity
+            memmove(static_cast<void*>(&data[index + 1]), &data[index], (v_size - index) * sizeof(T)); // Shift elements to the right
+            new (&data[index]) T(std::move(element));
         }
-        else // If vector has space
+        else
         {
-            T temp = data[index]; // Store the element at the specified index
-            data[index] = element; // Insert new element at specified index
-            
-            for(int i = index + 1 ; i <= v_size; i++) // Shift elements to the right
+            new (&data[v_size]) T(std::move(data[v_size - 1])); // The last element moves into the new slot
+            for (int i = v_size - 1; i > index; i--) // Shift elements to the right
             {
-                T temp2 = data[i];
-                data[i] = temp;
-                temp = temp2;
-                
+                data[i] = std::move(data[i - 1]);
             }
-            v_size++; // Increment vector size
+            data[index] = std::move(element); // Insert new element at specified index
         }
+        v_size++; // Increment vector size
     }
 
 }
@@ -198,9 +307,17 @@ void MyVector<T>::erase(int index)
     }
     else
     {
-        for (int i = index ; i < v_size - 1; i++) // Shift elements to the left
+        if (TRIVIAL)
         {
-            data[i] = data[i+1];
+            memmove(static_cast<void*>(&data[index]), &data[index + 1], (v_size - index - 1) * sizeof(T)); // Shift elements to the left
+        }
+        else
+        {
+            for (int i = index ; i < v_size - 1; i++) // Shift elements to the left
+            {
+                data[i] = std::move(data[i+1]);
+            }
+            data[v_size - 1].~T();
         }
         v_size--; // Decrement vector size
     }
@@ -213,6 +330,12 @@ T& MyVector<T>::operator[](int index)
 }
 //========================================
 template <typename T>
+const T& MyVector<T>::operator[](int index) const
+{
+    return data[index]; // Return reference to element at index
+}
+//========================================
+template <typename T>
 T& MyVector<T>::at(int index)
 {
     if (index < 0 || index > v_size - 1) // Check if index is out of range
@@ -256,17 +379,37 @@ void MyVector<T>::shrink_to_fit()		//Reduce vector capacity to fit its size.
 {
     if (v_capacity > v_size) // Check if capacity is greater than size
     {
-        T* temp = new T[v_size]; // Create temporary array with size equal to vector size
-        
-        for(int i = 0 ; i < v_size; i++) // Copy elements to temporary array
-        {
-            temp[i] = data[i];
-        }
-        
-        delete [] data; // Deallocate memory for current array
-        data = temp; // Update data pointer
-        v_capacity = v_size; // Set capacity equal to size
+        reallocate(v_size); // Set capacity equal to size
     }
 }
+//======================================
+template <typename T>
+void MyVector<T>::clear()
+{
+    destroyAll(); // The storage is kept for later insertions
+}
+//======================================
+template <typename T>
+typename MyVector<T>::iterator MyVector<T>::begin()
+{
+    return data;
+}
+//======================================
+template <typename T>
+typename MyVector<T>::iterator MyVector<T>::end()
+{
+    return data + v_size;
+}
+//======================================
+template <typename T>
+typename MyVector<T>::const_iterator MyVector<T>::begin() const
+{
+    return data;
+}
+//======================================
+template <typename T>
+typename MyVector<T>::const_iterator MyVector<T>::end() const
+{
+    return data + v_size;
+}
 #endif
-
@@ -0,0 +1,221 @@
+//============================================================================
+// Name         : pool.h
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Slab pool for the objects of the catalog
+//============================================================================
+#ifndef POOL_H
+#define POOL_H
+#include<new>
+#include<utility>
+#include<type_traits>
+#include<cstddef>
+using namespace std;
+
+// A Pool hands out objects of one type from slabs of SLAB_OBJECTS slots. A destroyed
+// object's slot goes on a free list and is reused by the next create(). clear() and the
+// destructor release the slabs all at once instead of freeing object by object, so
+// dropping a whole catalog costs one deallocation per slab.
+template <typename T, int SLAB_OBJECTS = 256>
+class Pool
+{
+	private:
+		struct Slot
+		{
+			typename aligned_storage<sizeof(T), alignof(T)>::type storage;	//the object, or the free list link
+			bool live;				//true while the slot holds an object
+		};
+		struct Slab
+		{
+			Slab* next;				//previously allocated slab
+			int used;				//slots handed out so far, the rest have never been used
+			Slot slots[SLAB_OBJECTS];
+		};
+
+		Slab* slabs;				//most recent slab first
+		Slot* freeList;				//destroyed slots, linked through their storage
+		long long liveCount;		//objects currently alive
+		long long createCount;		//objects ever created
+		long long reuseCount;		//objects created in a recycled slot
+		long long slabCount;		//slabs currently held
+
+		static_assert(sizeof(T) >= sizeof(void*), "a free slot must hold the free list link");
+
+		Pool(const Pool&);				//not copyable, the pool owns its objects
+		Pool& operator=(const Pool&);
+		static Slot*& link(Slot* slot) { return *reinterpret_cast<Slot**>(&slot->storage); }
+
+	public:
+		Pool();
+		~Pool();						//destroy every live object and free the slabs
+		template <typename... Args>
+		T* create(Args&&... args);		//construct an object in a free slot
+		void destroy(T* object);		//destroy an object created by this pool and recycle its slot
+		void clear();					//destroy every live object and free the slabs
+		void merge(Pool& other);		//take over the objects and slabs of another pool, leaving it empty
+		void swap(Pool& other);			//exchange the contents of two pools
+
+		long long live() const;			//objects currently alive
+		long long created() const;		//objects ever created
+		long long reused() const;		//objects created in a recycled slot
+		long long slabsHeld() const;	//slabs currently held, one heap allocation each
+		long long bytes() const;		//bytes of slab memory currently held
+};
+//========================================
+template <typename T, int SLAB_OBJECTS>
+Pool<T, SLAB_OBJECTS>::Pool()
+{
+    slabs = nullptr;
+    freeList = nullptr;
+    liveCount = createCount = reuseCount = slabCount = 0;
+}
+//========================================
+template <typename T, int SLAB_OBJECTS>
+Pool<T, SLAB_OBJECTS>::~Pool()
+{
+    clear();
+}
+//========================================
+template <typename T, int SLAB_OBJECTS>
+template <typename... Args>
+T* Pool<T, SLAB_OBJECTS>::create(Args&&... args)
+{
+    Slot* slot;
+    if (freeList != nullptr) // Recycle the most recently destroyed slot first, it is likely still cached
+    {
+        slot = freeList;
+        freeList = link(slot);
+        reuseCount++;
+    }
+    else
+    {
+        if (slabs == nullptr || slabs->used == SLAB_OBJECTS) // Current slab is full, start a new one
+        {
+            Slab* slab = static_cast<Slab*>(::operator new(sizeof(Slab)));
+            slab->next = slabs;
+            slab->used = 0;
+            slabs = slab;
+            slabCount++;
+        }
+        slot = &slabs->slots[slabs->used++];
+    }
+
+    slot->live = false;
+    T* object = new (&slot->storage) T(std::forward<Args>(args)...); // A throwing constructor leaves the slot unused
+    slot->live = true;
+    liveCount++;
+    createCount++;
+    return object;
+}
+//========================================
+template <typename T, int SLAB_OBJECTS>
+void Pool<T, SLAB_OBJECTS>::destroy(T* object)
+{
+    if (object == nullptr) return;
+    Slot* slot = reinterpret_cast<Slot*>(object); // The object is the first member of its slot
+    object->~T();
+    slot->live = false;
+    link(slot) = freeList;
+    freeList = slot;
+    liveCount--;
+}
+//========================================
+template <typename T, int SLAB_OBJECTS>
+void Pool<T, SLAB_OBJECTS>::clear()
+{
+    while (slabs != nullptr)
+    {
+        Slab* slab = slabs;
+        slabs = slab->next;
+        if (!is_trivially_destructible<T>::value) // Only members that own memory need a visit
+        {
+            for (int i = 0; i < slab->used; i++)
+            {
+                if (slab->slots[i].live) reinterpret_cast<T*>(&slab->slots[i].storage)->~T();
+            }
+        }
+        ::operator delete(slab);
+    }
+    freeList = nullptr;
+    liveCount = slabCount = 0;
+}
+//========================================
+template <typename T, int SLAB_OBJECTS>
+void Pool<T, SLAB_OBJECTS>::merge(Pool& other)
+{
+    if (other.slabs == nullptr) return;
+
+    // Append our slabs behind the other pool's, so our partly used current slab stays current
+    Slab* last = other.slabs;
+    while (last->next != nullptr) last = last->next;
+    last->next = slabs;
+    Slab* adopted = other.slabs;
+    if (slabs != nullptr && slabs->used < SLAB_OBJECTS) // Keep filling our current slab
+    {
+        last->next = slabs->next;
+        slabs->next = adopted;
+    }
+    else
+    {
+        slabs = adopted; // The other pool's current slab becomes ours
+    }
+
+    while (other.freeList != nullptr) // Few slots: the books an import discarded
+    {
+        Slot* slot = other.freeList;
+        other.freeList = link(slot);
+        link(slot) = freeList;
+        freeList = slot;
+    }
+
+    liveCount += other.liveCount;
+    createCount += other.createCount;
+    reuseCount += other.reuseCount;
+    slabCount += other.slabCount;
+    other.slabs = nullptr;
+    other.liveCount = other.slabCount = 0;
+}
+//========================================
+template <typename T, int SLAB_OBJECTS>
+void Pool<T, SLAB_OBJECTS>::swap(Pool& other)
+{
+    std::swap(slabs, other.slabs);
+    std::swap(freeList, other.freeList);
+    std::swap(liveCount, other.liveCount);
+    std::swap(createCount, other.createCount);
+    std::swap(reuseCount, other.reuseCount);
+    std::swap(slabCount, other.slabCount);
+}
+//========================================
+template <typename T, int SLAB_OBJECTS>
+long long Pool<T, SLAB_OBJECTS>::live() const
+{
+    return liveCount;
+}
+//========================================
+template <typename T, int SLAB_OBJECTS>
+long long Pool<T, SLAB_OBJECTS>::created() const
+{
+    return createCount;
+}
+//========================================
+template <typename T, int SLAB_OBJECTS>
+long long Pool<T, SLAB_OBJECTS>::reused() const
+{
+    return reuseCount;
+}
+//========================================
+template <typename T, int SLAB_OBJECTS>
+long long Pool<T, SLAB_OBJECTS>::slabsHeld() const
+{
+    return slabCount;
+}
+//========================================
+template <typename T, int SLAB_OBJECTS>
+long long Pool<T, SLAB_OBJECTS>::bytes() const
+{
+    return slabCount * (long long)sizeof(Slab);
+}
+#endif
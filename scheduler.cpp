@@ -0,0 +1,118 @@
+//============================================================================
+// Name         : scheduler.cpp
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  :
+//============================================================================
+#include "scheduler.h" // Include the header file for the Scheduler class
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Helper function to pack the bounds of a slice into one word, so both ends change with one CAS
+static uint64_t bounds(uint32_t front, uint32_t back)
+{
+    return (static_cast<uint64_t>(front) << 32) | back;
+}
+
+// Method for the owner of a slice to take its next task
+bool Scheduler::takeFront(Slice& slice, uint32_t& task)
+{
+    uint64_t current = slice.bounds.load();
+    while (true)
+    {
+        uint32_t front = current >> 32, back = static_cast<uint32_t>(current);
+        if (front >= back) return false; // The slice is empty
+        if (slice.bounds.compare_exchange_weak(current, bounds(front + 1, back)))
+        {
+            task = front;
+            return true;
+        }
+    }
+}
+
+// Method for another thread to take the last task of a slice; the owner keeps working from the front
+bool Scheduler::stealBack(Slice& slice, uint32_t& task)
+{
+    uint64_t current = slice.bounds.load();
+    while (true)
+    {
+        uint32_t front = current >> 32, back = static_cast<uint32_t>(current);
+        if (front >= back) return false; // Nothing left to steal
+        if (slice.bounds.compare_exchange_weak(current, bounds(front, back - 1)))
+        {
+            task = back - 1;
+            return true;
+        }
+    }
+}
+
+// Helper method for one thread: run its own slice, then steal until every slice is empty
+void Scheduler::work(Slice* slices, int threads, int self, const function<void(int)>& task)
+{
+    uint32_t next;
+    while (takeFront(slices[self], next)) task(next);
+
+    bool stole = true;
+    while (stole) // A pass that finds nothing anywhere means every task has been taken
+    {
+        stole = false;
+        for (int i = 1; i < threads; ++i)
+        {
+            Slice& victim = slices[(self + i) % threads]; // Start with the next thread so thieves spread out
+            if (stealBack(victim, next))
+            {
+                task(next);
+                stole = true;
+                break;
+            }
+        }
+    }
+}
+
+// Method to run the tasks 0..count-1 on a number of threads, the calling thread being one of them
+void Scheduler::run(int count, int threads, const function<void(int)>& task)
+{
+    if (threads > count) threads = count; // A thread without a task of its own would only steal
+    if (threads <= 1) // Small scans are not worth starting threads for
+    {
+        for (int i = 0; i < count; ++i) task(i);
+        return;
+    }
+
+    unique_ptr<Slice[]> slices(new Slice[threads]);
+    for (int t = 0; t < threads; ++t) // Even slices, the first count % threads get one task more
+    {
+        uint32_t front = static_cast<uint64_t>(count) * t / threads;
+        uint32_t back = static_cast<uint64_t>(count) * (t + 1) / threads;
+        slices[t].bounds.store(bounds(front, back));
+    }
+
+    mutex failedLock;
+    exception_ptr failed; // First exception thrown by a task
+    function<void(int)> guarded = [&](int i) {
+        try {
+            task(i);
+        } catch (...) {
+            lock_guard<mutex> guard(failedLock);
+            if (!failed) failed = current_exception();
+        }
+    };
+
+    vector<thread> workers;
+    for (int t = 1; t < threads; ++t)
+    {
+        workers.push_back(thread(work, slices.get(), threads, t, cref(guarded)));
+    }
+    work(slices.get(), threads, 0, guarded); // The calling thread runs slice 0
+    for (size_t t = 0; t < workers.size(); ++t)
+    {
+        workers[t].join();
+    }
+    if (failed) rethrow_exception(failed);
+}
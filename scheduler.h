@@ -0,0 +1,38 @@
+//============================================================================
+// Name         : scheduler.h
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Work-stealing scheduler for parallel catalog scans
+//============================================================================
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+#include<atomic>
+#include<cstdint>
+#include<functional>
+
+// The Scheduler runs the tasks 0..count-1 of a scan on a number of threads, the calling
+// thread included. Each thread starts with an even slice of the task numbers and takes
+// them from the front of its slice; a thread that runs dry steals from the back of
+// another thread's slice, so a slice that is slow to run (large categories, a core busy
+// elsewhere) is shared out instead of leaving the other threads idle. Tasks must not
+// depend on each other. The first exception a task throws is rethrown by run() once
+// every thread has stopped.
+class Scheduler
+{
+	private:
+		struct Slice
+		{
+			std::atomic<uint64_t> bounds;	//next task to take in the high 32 bits, end of the slice in the low 32
+			char padding[64 - sizeof(std::atomic<uint64_t>)];	//a cache line per thread, the bounds are hammered by CAS
+		};
+
+		static bool takeFront(Slice& slice, uint32_t& task);	//the owner takes the next task of its slice
+		static bool stealBack(Slice& slice, uint32_t& task);	//another thread takes the last task of a slice
+		static void work(Slice* slices, int threads, int self, const std::function<void(int)>& task);
+
+	public:
+		static void run(int count, int threads, const std::function<void(int)>& task);	//run every task, return when all are done
+};
+#endif
@@ -0,0 +1,282 @@
+//============================================================================
+// Name         : smallvector.h
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Vector with inline capacity for short per-book and per-borrower lists
+//============================================================================
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+#include<cstdlib>
+#include<cstring>
+#include<new>
+#include<stdexcept>
+#include<type_traits>
+using namespace std;
+
+// A SmallVector keeps its first N elements inside the object and only goes to the heap
+// when an (N+1)-th element arrives. Most books have a handful of borrowers and most
+// borrowers hold a handful of books, so most lists never allocate at all. The inline
+// slots share their bytes with the heap pointer, so the object is no larger than
+// max(N elements, one pointer) plus the two counters. Elements must be trivially
+// copyable (pointers, ints), they are moved with memcpy.
+template <typename T, int N>
+class SmallVector
+{
+	static_assert(is_trivially_copyable<T>::value, "SmallVector elements are moved with memcpy");
+	static_assert(N > 0, "SmallVector needs at least one inline slot");
+
+	private:
+		union
+		{
+			T local[N];					//the elements while they fit inline
+			T* heap;					//the elements once they have spilled
+		};
+		int v_size;						//current size of vector (number of elements in vector)
+		int v_capacity;					//N while inline, the heap capacity afterwards
+
+		T* elements();					//where the elements currently live
+		const T* elements() const;
+		void release();					//free the heap storage, if any, and go back inline
+		void copyFrom(const SmallVector& other);	//take a copy of the elements of other, this vector must be inline
+		void stealFrom(SmallVector& other);			//take the storage of other, leaving it empty and inline
+	public:
+		typedef T* iterator;
+		typedef const T* const_iterator;
+
+		SmallVector();					//Empty vector, storage is inline
+		SmallVector(const SmallVector& other);		//Copy Constructor
+		SmallVector(SmallVector&& other) noexcept;	//Move Constructor, steals heap storage
+		SmallVector& operator=(const SmallVector& other);	//Copy Assignment
+		SmallVector& operator=(SmallVector&& other) noexcept;	//Move Assignment
+		~SmallVector();					//Destructor
+		void push_back(const T& element);	//Add an element at the end of vector
+		void erase(int index);			//Removes an element from the index
+		T& operator[](int index);		//return reference of the element at index
+		const T& operator[](int index) const;
+		int size() const;				//Return current size of vector
+		int capacity() const;			//Return capacity of vector
+		bool empty() const; 			//Return true if the vector is empty, False otherwise
+		bool isInline() const;			//Return true if the elements are stored inside the object
+		size_t heapBytes() const;		//bytes allocated on the heap, 0 while inline
+		void clear();					//Remove all elements, keeping the capacity
+		iterator begin();				//First element, for range-based for
+		iterator end();					//One past the last element
+		const_iterator begin() const;
+		const_iterator end() const;
+};
+//========================================
+template <typename T, int N>
+SmallVector<T, N>::SmallVector()
+{
+    v_size = 0;
+    v_capacity = N;
+}
+//========================================
+template <typename T, int N>
+SmallVector<T, N>::SmallVector(const SmallVector& other)
+{
+    v_size = 0;
+    v_capacity = N;
+    copyFrom(other);
+}
+//========================================
+template <typename T, int N>
+SmallVector<T, N>::SmallVector(SmallVector&& other) noexcept
+{
+    v_size = 0;
+    v_capacity = N;
+    stealFrom(other);
+}
+//========================================
+template <typename T, int N>
+SmallVector<T, N>& SmallVector<T, N>::operator=(const SmallVector& other)
+{
+    if (this != &other)
+    {
+        release();
+        copyFrom(other);
+    }
+    return *this;
+}
+//========================================
+template <typename T, int N>
+SmallVector<T, N>& SmallVector<T, N>::operator=(SmallVector&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        stealFrom(other);
+    }
+    return *this;
+}
+//========================================
+template <typename T, int N>
+SmallVector<T, N>::~SmallVector()
+{
+    release();
+}
+//========================================
+template <typename T, int N>
+T* SmallVector<T, N>::elements()
+{
+    return (v_capacity > N) ? heap : local;
+}
+//========================================
+template <typename T, int N>
+const T* SmallVector<T, N>::elements() const
+{
+    return (v_capacity > N) ? heap : local;
+}
+//========================================
+template <typename T, int N>
+void SmallVector<T, N>::release()
+{
+    if (v_capacity > N) free(heap);
+    v_size = 0;
+    v_capacity = N;
+}
+//========================================
+template <typename T, int N>
+void SmallVector<T, N>::copyFrom(const SmallVector& other)
+{
+    if (other.v_size > N) // Spilled lists are copied to a heap block of exactly their size
+    {
+        T* block = static_cast<T*>(malloc(other.v_size * sizeof(T)));
+        if (block == nullptr) throw bad_alloc();
+        heap = block;
+        v_capacity = other.v_size;
+    }
+    if (other.v_size > 0) memcpy(static_cast<void*>(elements()), other.elements(), other.v_size * sizeof(T));
+    v_size = other.v_size;
+}
+//========================================
+template <typename T, int N>
+void SmallVector<T, N>::stealFrom(SmallVector& other)
+{
+    if (other.v_capacity > N)
+    {
+        heap = other.heap; // Take the heap block, no element is touched
+    }
+    else if (other.v_size > 0)
+    {
+        memcpy(static_cast<void*>(local), other.local, other.v_size * sizeof(T));
+    }
+    v_size = other.v_size;
+    v_capacity = other.v_capacity;
+    other.v_size = 0; // other is left empty and inline
+    other.v_capacity = N;
+}
+//========================================
+template <typename T, int N>
+void SmallVector<T, N>::push_back(const T& element)
+{
+    if (v_size == v_capacity) // Full: spill to the heap, or double the heap block
+    {
+        T copy = element; // The element may live in the storage about to move
+        int cap = v_capacity * 2;
+        T* block;
+        if (v_capacity > N)
+        {
+            block = static_cast<T*>(realloc(static_cast<void*>(heap), cap * sizeof(T)));
+            if (block == nullptr) throw bad_alloc();
+        }
+        else
+        {
+            block = static_cast<T*>(malloc(cap * sizeof(T)));
+            if (block == nullptr) throw bad_alloc();
+            memcpy(static_cast<void*>(block), local, v_size * sizeof(T));
+        }
+        heap = block;
+        v_capacity = cap;
+        heap[v_size++] = copy;
+        return;
+    }
+    elements()[v_size++] = element; // Add element to vector
+}
+//========================================
+template <typename T, int N>
+void SmallVector<T, N>::erase(int index)
+{
+    if (index < 0 || index > v_size - 1) // Check if index is out of range
+    {
+        throw out_of_range("Vector index out of range"); // Throw exception if index is out of range
+    }
+    T* data = elements();
+    memmove(static_cast<void*>(&data[index]), &data[index + 1], (v_size - index - 1) * sizeof(T)); // Shift elements to the left
+    v_size--; // Decrement vector size
+}
+//========================================
+template <typename T, int N>
+T& SmallVector<T, N>::operator[](int index)
+{
+    return elements()[index]; // Return reference to element at index
+}
+//========================================
+template <typename T, int N>
+const T& SmallVector<T, N>::operator[](int index) const
+{
+    return elements()[index]; // Return reference to element at index
+}
+//========================================
+template <typename T, int N>
+int SmallVector<T, N>::size() const
+{
+    return v_size; // Return the size of the vector
+}
+//========================================
+template <typename T, int N>
+int SmallVector<T, N>::capacity() const
+{
+    return v_capacity; // Return the capacity of the vector
+}
+//========================================
+template <typename T, int N>
+bool SmallVector<T, N>::empty() const
+{
+    return v_size == 0; // Return true if vector is empty, false otherwise
+}
+//========================================
+template <typename T, int N>
+bool SmallVector<T, N>::isInline() const
+{
+    return v_capacity == N;
+}
+//========================================
+template <typename T, int N>
+size_t SmallVector<T, N>::heapBytes() const
+{
+    return (v_capacity > N) ? v_capacity * sizeof(T) : 0;
+}
+//========================================
+template <typename T, int N>
+void SmallVector<T, N>::clear()
+{
+    v_size = 0; // The heap block, if any, is kept for later insertions
+}
+//========================================
+template <typename T, int N>
+typename SmallVector<T, N>::iterator SmallVector<T, N>::begin()
+{
+    return elements();
+}
+//========================================
+template <typename T, int N>
+typename SmallVector<T, N>::iterator SmallVector<T, N>::end()
+{
+    return elements() + v_size;
+}
+//========================================
+template <typename T, int N>
+typename SmallVector<T, N>::const_iterator SmallVector<T, N>::begin() const
+{
+    return elements();
+}
+//========================================
+template <typename T, int N>
+typename SmallVector<T, N>::const_iterator SmallVector<T, N>::end() const
+{
+    return elements() + v_size;
+}
+#endif
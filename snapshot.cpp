@@ -0,0 +1,124 @@
+//============================================================================
+// Name         : snapshot.cpp
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : 
+//============================================================================
+#include "snapshot.h" // Include the header file for the snapshot layout
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+using namespace std;
+
+// Helper function to check that a table of a snapshot lies inside the file
+static const char* snapshotTable(const MappedFile& file, uint64_t offset, uint64_t count, size_t recordSize)
+{
+    if (offset % 8 != 0 || offset > file.size() || count > (file.size() - offset) / recordSize)
+    {
+        throw runtime_error("Invalid snapshot file");
+    }
+    return file.data() + offset;
+}
+
+// Constructor: validate the header, the table bounds and every cross reference
+SnapshotReader::SnapshotReader(const MappedFile& file) : file(file)
+{
+    header = reinterpret_cast<const SnapHeader*>(file.data());
+    if (file.size() < offsetof(SnapHeader, titlesOffset) || memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0)
+    {
+        throw runtime_error("Invalid snapshot file");
+    }
+    if (header->version < 1 || header->version > SNAPSHOT_VERSION)
+    {
+        throw runtime_error("Unsupported snapshot version " + to_string(header->version));
+    }
+    size_t headerSize = (header->version == 1) ? offsetof(SnapHeader, titlesOffset) // Each version appends to the header
+                      : (header->version == 2) ? offsetof(SnapHeader, journalSequence) : sizeof(SnapHeader);
+    if (file.size() < headerSize)
+    {
+        throw runtime_error("Invalid snapshot file");
+    }
+    journalSequence = (header->version >= 3) ? header->journalSequence : 0;
+
+    nodes = reinterpret_cast<const SnapNode*>(snapshotTable(file, header->nodesOffset, header->nodeCount, sizeof(SnapNode)));
+    books = reinterpret_cast<const SnapBook*>(snapshotTable(file, header->booksOffset, header->bookCount, sizeof(SnapBook)));
+    borrowers = reinterpret_cast<const SnapBorrower*>(snapshotTable(file, header->borrowersOffset, header->borrowerCount, sizeof(SnapBorrower)));
+    loans = reinterpret_cast<const SnapLoan*>(snapshotTable(file, header->loansOffset, header->loanCount, sizeof(SnapLoan)));
+    history = reinterpret_cast<const uint32_t*>(snapshotTable(file, header->historyOffset, header->historyCount, sizeof(uint32_t)));
+    strings = snapshotTable(file, header->stringsOffset, header->stringsSize, 1);
+    titles = (header->version >= 2) ? reinterpret_cast<const uint32_t*>(snapshotTable(file, header->titlesOffset, header->bookCount, sizeof(uint32_t))) : nullptr;
+
+    // Nodes: a root first, parents before children, subtrees nested inside their parent's
+    if (header->nodeCount == 0 || nodes[0].parent != SNAPSHOT_NONE || nodes[0].subtreeEnd != header->nodeCount)
+    {
+        throw runtime_error("Invalid snapshot file");
+    }
+    for (uint32_t i = 0; i < header->nodeCount; i++)
+    {
+        const SnapNode& node = nodes[i];
+        text(node.name);
+        if (node.subtreeEnd <= i || node.subtreeEnd > header->nodeCount || node.firstBook > header->bookCount || node.ownBooks > header->bookCount - node.firstBook)
+        {
+            throw runtime_error("Invalid snapshot file");
+        }
+        uint32_t previousEnd = (i == 0) ? 0 : nodes[i - 1].firstBook + nodes[i - 1].ownBooks;
+        if (node.firstBook != previousEnd) // Books are grouped by node in pre-order
+        {
+            throw runtime_error("Invalid snapshot file");
+        }
+        if (i > 0 && (node.parent >= i || i >= nodes[node.parent].subtreeEnd || node.subtreeEnd > nodes[node.parent].subtreeEnd))
+        {
+            throw runtime_error("Invalid snapshot file");
+        }
+    }
+    if (nodes[header->nodeCount - 1].firstBook + nodes[header->nodeCount - 1].ownBooks != header->bookCount)
+    {
+        throw runtime_error("Invalid snapshot file");
+    }
+    for (uint32_t i = 0; i < header->bookCount; i++)
+    {
+        const SnapBook& book = books[i];
+        text(book.title);
+        text(book.author);
+        text(book.isbn);
+        if (book.node >= header->nodeCount || book.historyFirst > header->historyCount || book.historyCount > header->historyCount - book.historyFirst)
+        {
+            throw runtime_error("Invalid snapshot file");
+        }
+        if (titles != nullptr && titles[i] >= header->bookCount)
+        {
+            throw runtime_error("Invalid snapshot file");
+        }
+    }
+    for (uint32_t i = 0; i < header->borrowerCount; i++)
+    {
+        text(borrowers[i].name);
+        text(borrowers[i].id);
+    }
+    for (uint32_t i = 0; i < header->historyCount; i++)
+    {
+        if (history[i] >= header->borrowerCount) throw runtime_error("Invalid snapshot file");
+    }
+    for (uint32_t i = 0; i < header->loanCount; i++)
+    {
+        if (loans[i].borrower >= header->borrowerCount || loans[i].book >= header->bookCount) throw runtime_error("Invalid snapshot file");
+    }
+}
+
+// Method to get the first byte of a string in the pool, checking its bounds
+const char* SnapshotReader::text(const SnapString& ref) const
+{
+    if (ref.offset > header->stringsSize || ref.length > header->stringsSize - ref.offset)
+    {
+        throw runtime_error("Invalid snapshot file");
+    }
+    return strings + ref.offset;
+}
+
+// Method to copy a string out of the pool
+string SnapshotReader::str(const SnapString& ref) const
+{
+    return string(text(ref), ref.length);
+}
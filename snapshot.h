@@ -0,0 +1,118 @@
+//============================================================================
+// Name         : snapshot.h
+// Author       : Sebahadin Aman Denur 
+// Version      : 
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : On-disk layout of binary catalog snapshots
+//============================================================================
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+#include<stdint.h>
+#include<string>
+#include "mappedfile.h"
+
+// A snapshot is a header followed by fixed-size record tables and a string pool.
+// Records refer to each other by index and to text by offset into the pool, so the
+// file has no pointers and can be read in place. Integers use the native byte order.
+//
+//  nodes     : pre-order, node 0 is the root; the children of a node follow it in order
+//              and its subtree ends at subtreeEnd
+//  books     : grouped by node in pre-order, so a node's books are [firstBook, firstBook + ownBooks)
+//              and a subtree's books are [firstBook, nodes[subtreeEnd].firstBook)
+//  borrowers : every registered borrower
+//  loans     : active (borrower, book) pairs
+//  history   : borrower indices, books[i].historyFirst/historyCount select a book's allBorrowers
+//  titles    : (version 2) book indices sorted by title, ties in book order, for lookups in place
+//
+// Each version only appends fields to the header, so older files are still readable.
+
+const char SNAPSHOT_MAGIC[8] = { 'L', 'C', 'M', 'S', 'S', 'N', 'A', 'P' };
+const uint32_t SNAPSHOT_VERSION = 3;
+const uint32_t SNAPSHOT_NONE = 0xFFFFFFFFu;		//parent of the root
+
+struct SnapString
+{
+	uint64_t offset;		//offset of the text in the string pool
+	uint64_t length;		//number of bytes
+};
+
+struct SnapHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t nodeCount;
+	uint32_t bookCount;
+	uint32_t borrowerCount;
+	uint32_t loanCount;
+	uint32_t historyCount;
+	uint64_t nodesOffset;
+	uint64_t booksOffset;
+	uint64_t borrowersOffset;
+	uint64_t loansOffset;
+	uint64_t historyOffset;
+	uint64_t stringsOffset;
+	uint64_t stringsSize;
+	uint64_t titlesOffset;		//version 2 and later; a version 1 header ends before this field
+	uint64_t journalSequence;	//version 3 and later: last journal record the snapshot includes
+};
+
+struct SnapNode
+{
+	SnapString name;
+	uint32_t parent;		//index of the parent node, SNAPSHOT_NONE for the root
+	uint32_t subtreeEnd;	//index one past the last node of the subtree
+	uint32_t firstBook;		//index of the first book of the node
+	uint32_t ownBooks;		//number of books directly in the node
+	uint32_t bookCount;		//number of books in the whole subtree
+	uint32_t depth;			//0 for the root
+};
+
+struct SnapBook
+{
+	SnapString title;
+	SnapString author;
+	SnapString isbn;
+	int32_t publicationYear;
+	int32_t totalCopies;
+	int32_t availableCopies;
+	uint32_t node;			//index of the node holding the book
+	uint32_t historyFirst;	//first entry of the book in the history table
+	uint32_t historyCount;	//number of borrowers that ever borrowed the book
+};
+
+struct SnapBorrower
+{
+	SnapString name;
+	SnapString id;
+};
+
+struct SnapLoan
+{
+	uint32_t borrower;
+	uint32_t book;
+};
+
+// Validated, read-only access to the tables of a mapped snapshot. Every offset and
+// index is checked once when the reader is created; the tables are read in place.
+class SnapshotReader
+{
+	private:
+		const MappedFile& file;
+
+	public:
+		const SnapHeader* header;
+		const SnapNode* nodes;
+		const SnapBook* books;
+		const SnapBorrower* borrowers;
+		const SnapLoan* loans;
+		const uint32_t* history;
+		const uint32_t* titles;		//nullptr for version 1 snapshots
+		const char* strings;
+		uint64_t journalSequence;	//0 for snapshots older than version 3
+
+		SnapshotReader(const MappedFile& file);		//throws runtime_error if the file is not a valid snapshot
+		std::string str(const SnapString& ref) const;	//copy a string out of the pool
+		const char* text(const SnapString& ref) const;	//first byte of a string in the pool
+};
+#endif
@@ -0,0 +1,82 @@
+//============================================================================
+// Name         : stringpool.cpp
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  :
+//============================================================================
+#include "stringpool.h" // Include the header file for the StringPool class
+#include <functional>
+using namespace std;
+
+// Size of a string's heap buffer, 0 while it fits the small-string buffer inside the object
+static size_t heapBytes(const string& text)
+{
+    return (text.capacity() > 15) ? text.capacity() + 1 : 0;
+}
+
+// Constructor: every shard starts empty
+StringPool::StringPool()
+{
+}
+
+// Method to intern a string: the first caller stores a copy, everyone gets its address
+const string* StringPool::intern(const string& text)
+{
+    size_t h = hash<string>()(text);
+    Shard& shard = shards[(h >> 7) % SHARDS]; // Low bits pick the bucket inside the shard
+    lock_guard<mutex> guard(shard.lock);
+    pair<unordered_set<string>::iterator, bool> result = shard.strings.insert(text);
+    if (result.second) shard.bytes += heapBytes(*result.first); // A new string
+    return &*result.first;
+}
+
+// Method to look a string up without interning it, for lookups by a field's value
+const string* StringPool::find(const string& text)
+{
+    size_t h = hash<string>()(text);
+    Shard& shard = shards[(h >> 7) % SHARDS];
+    lock_guard<mutex> guard(shard.lock);
+    unordered_set<string>::const_iterator it = shard.strings.find(text);
+    return (it == shard.strings.end()) ? nullptr : &*it;
+}
+
+// Method to count the distinct strings of the pool
+size_t StringPool::size()
+{
+    size_t count = 0;
+    for (int i = 0; i < SHARDS; ++i)
+    {
+        lock_guard<mutex> guard(shards[i].lock);
+        count += shards[i].strings.size();
+    }
+    return count;
+}
+
+// Method to estimate the memory of the pool: hash nodes, bucket arrays and string buffers
+size_t StringPool::bytes()
+{
+    size_t total = 0;
+    for (int i = 0; i < SHARDS; ++i)
+    {
+        lock_guard<mutex> guard(shards[i].lock);
+        total += shards[i].strings.size() * (sizeof(string) + 2 * sizeof(void*)); // Node: next link, cached hash, string
+        total += shards[i].strings.bucket_count() * sizeof(void*);
+        total += shards[i].bytes;
+    }
+    return total;
+}
+
+// Method to estimate the memory of the shards' hash tables alone: bucket arrays and the links of their nodes
+size_t StringPool::tableBytes()
+{
+    size_t total = 0;
+    for (int i = 0; i < SHARDS; ++i)
+    {
+        lock_guard<mutex> guard(shards[i].lock);
+        total += shards[i].strings.size() * 2 * sizeof(void*); // Next link and cached hash of each node
+        total += shards[i].strings.bucket_count() * sizeof(void*);
+    }
+    return total;
+}
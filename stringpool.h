@@ -0,0 +1,45 @@
+//============================================================================
+// Name         : stringpool.h
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Interning pool for strings that repeat across the catalog
+//============================================================================
+#ifndef _STRINGPOOL_H
+#define _STRINGPOOL_H
+#include<cstddef>
+#include<string>
+#include<mutex>
+#include<unordered_set>
+
+// A StringPool keeps one copy of each distinct string and hands out a pointer to it.
+// Equal strings get the same pointer, so handles are compared with ==. The copies live
+// as long as the pool: a string that is no longer used stays interned, which is cheap
+// for fields that repeat (authors, category names) and bounded by their distinct values.
+// The pool is split into shards with a lock each, so import workers can intern together.
+class StringPool
+{
+	private:
+		static const int SHARDS = 16;
+		struct Shard
+		{
+			std::mutex lock;						//guards the strings of this shard
+			std::unordered_set<std::string> strings;	//one copy per distinct string, nodes never move
+			size_t bytes;							//characters held on the heap by the copies
+			Shard() : bytes(0) {}
+		};
+		Shard shards[SHARDS];
+
+		StringPool(const StringPool&);				//not copyable, handles point into the pool
+		StringPool& operator=(const StringPool&);
+
+	public:
+		StringPool();
+		const std::string* intern(const std::string& text);	//return the pool's copy of text, adding it on first use
+		const std::string* find(const std::string& text);	//return the pool's copy of text, nullptr if it was never interned
+		size_t size();								//number of distinct strings
+		size_t bytes();								//approximate memory held by the pool
+		size_t tableBytes();						//the part of bytes() spent on the shards' hash tables rather than the strings
+};
+#endif
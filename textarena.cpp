@@ -0,0 +1,191 @@
+//============================================================================
+// Name         : textarena.cpp
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  :
+//============================================================================
+#include "textarena.h" // Include the header file for the TextArena class
+#include <cstring>
+#include <new>
+#include <utility>
+using namespace std;
+
+// Operator to compare two views by their characters
+bool TextRef::operator==(const TextRef& other) const
+{
+    return length == other.length && memcmp(text, other.text, length) == 0;
+}
+
+// Operator to order two views by their bytes, a prefix first, like std::string::compare
+bool TextRef::operator<(const TextRef& other) const
+{
+    int order = memcmp(text, other.text, (length < other.length) ? length : other.length);
+    return (order != 0) ? order < 0 : length < other.length;
+}
+
+// Hash of the characters of a view (FNV-1a)
+size_t TextRefHash::operator()(const TextRef& ref) const
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < ref.length; ++i)
+    {
+        h = (h ^ static_cast<unsigned char>(ref.text[i])) * 1099511628211ULL;
+    }
+    return static_cast<size_t>(h);
+}
+
+// Constructor: an arena starts without chunks
+TextArena::TextArena()
+{
+    chunks = nullptr;
+    chunkCount = heldBytes = liveBytes = deadBytes = 0;
+}
+
+// Destructor: free every chunk
+TextArena::~TextArena()
+{
+    clear();
+}
+
+// Helper method to get the bytes a string takes: its length prefix, its characters and a NUL,
+// rounded up so the next prefix stays aligned
+size_t TextArena::footprint(size_t length)
+{
+    return (sizeof(uint32_t) + length + 1 + alignof(uint32_t) - 1) & ~(alignof(uint32_t) - 1);
+}
+
+// Method to copy a string into the arena and return its first character
+const char* TextArena::add(const char* text, size_t length)
+{
+    size_t need = footprint(length);
+    if (chunks == nullptr || chunks->size - chunks->used < need) // Current chunk is full, start a new one
+    {
+        size_t size = (need > CHUNK_BYTES) ? need : CHUNK_BYTES; // A very long string gets a chunk of its own
+        Chunk* chunk = static_cast<Chunk*>(::operator new(offsetof(Chunk, text) + size));
+        chunk->next = chunks;
+        chunk->used = 0;
+        chunk->size = size;
+        chunks = chunk;
+        chunkCount++;
+        heldBytes += offsetof(Chunk, text) + size;
+    }
+
+    char* slot = chunks->text + chunks->used;
+    uint32_t prefix = static_cast<uint32_t>(length);
+    memcpy(slot, &prefix, sizeof(prefix)); // Length first, so length() does not scan for the NUL
+    memcpy(slot + sizeof(prefix), text, length);
+    slot[sizeof(prefix) + length] = '\0';
+    chunks->used += need;
+    liveBytes += need;
+    return slot + sizeof(prefix);
+}
+
+// Method to copy a std::string into the arena
+const char* TextArena::add(const string& text)
+{
+    return add(text.data(), text.size());
+}
+
+// Method to count a string as dead, its bytes are only reclaimed with the whole arena
+void TextArena::release(const char* text)
+{
+    size_t need = footprint(length(text));
+    liveBytes -= need;
+    deadBytes += need;
+}
+
+// Method to take over the chunks of another arena; the strings keep their addresses
+void TextArena::merge(TextArena& other)
+{
+    if (other.chunks == nullptr) return;
+
+    // Put the other arena's chunks behind our current chunk, which keeps being filled
+    Chunk* last = other.chunks;
+    while (last->next != nullptr) last = last->next;
+    if (chunks != nullptr)
+    {
+        last->next = chunks->next;
+        chunks->next = other.chunks;
+    }
+    else
+    {
+        chunks = other.chunks;
+    }
+
+    chunkCount += other.chunkCount;
+    heldBytes += other.heldBytes;
+    liveBytes += other.liveBytes;
+    deadBytes += other.deadBytes;
+    other.chunks = nullptr;
+    other.chunkCount = other.heldBytes = other.liveBytes = other.deadBytes = 0;
+}
+
+// Method to exchange the contents of two arenas
+void TextArena::swap(TextArena& other)
+{
+    std::swap(chunks, other.chunks);
+    std::swap(chunkCount, other.chunkCount);
+    std::swap(heldBytes, other.heldBytes);
+    std::swap(liveBytes, other.liveBytes);
+    std::swap(deadBytes, other.deadBytes);
+}
+
+// Method to free every chunk, which frees every string at once
+void TextArena::clear()
+{
+    while (chunks != nullptr)
+    {
+        Chunk* chunk = chunks;
+        chunks = chunk->next;
+        ::operator delete(chunk);
+    }
+    chunkCount = heldBytes = liveBytes = deadBytes = 0;
+}
+
+// Method to read the length of a string of an arena from the prefix in front of it
+size_t TextArena::length(const char* text)
+{
+    uint32_t prefix;
+    memcpy(&prefix, text - sizeof(prefix), sizeof(prefix));
+    return prefix;
+}
+
+// Method to get a view of a string of an arena
+TextRef TextArena::ref(const char* text)
+{
+    TextRef view = { text, length(text) };
+    return view;
+}
+
+// Method to get a view of the characters of a std::string, valid while the string is unchanged
+TextRef TextArena::ref(const string& text)
+{
+    TextRef view = { text.data(), text.size() };
+    return view;
+}
+
+// Method to get the number of chunks held
+size_t TextArena::chunksHeld() const
+{
+    return chunkCount;
+}
+
+// Method to get the bytes of chunk memory held
+size_t TextArena::bytes() const
+{
+    return heldBytes;
+}
+
+// Method to get the bytes of strings in use
+size_t TextArena::live() const
+{
+    return liveBytes;
+}
+
+// Method to get the bytes of strings no longer in use
+size_t TextArena::dead() const
+{
+    return deadBytes;
+}
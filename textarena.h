@@ -0,0 +1,75 @@
+//============================================================================
+// Name         : textarena.h
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Arena for the titles of the catalog's books
+//============================================================================
+#ifndef _TEXTARENA_H
+#define _TEXTARENA_H
+#include<cstddef>
+#include<cstdint>
+#include<string>
+
+// A view of characters stored elsewhere, for keying hash tables by arena strings (or by
+// the bytes of a std::string being looked up) without copying them
+struct TextRef
+{
+	const char* text;			//first character
+	size_t length;				//number of characters
+	bool operator==(const TextRef& other) const;
+	bool operator<(const TextRef& other) const;	//byte order, the order of std::string
+};
+struct TextRefHash
+{
+	size_t operator()(const TextRef& ref) const;
+};
+
+// A TextArena packs strings back to back in large chunks instead of giving each one a
+// heap block. Each string is stored NUL-terminated behind a 32-bit length, and users
+// hold a pointer to its first character. A string is never moved, and it is only freed
+// with the whole arena. A replaced or released string stays in its chunk and is counted
+// as dead bytes until the catalog is reloaded. Like Pool, an arena is filled by one
+// thread at a time, and import workers fill arenas of their own that the tree adopts.
+class TextArena
+{
+	private:
+		struct Chunk
+		{
+			Chunk* next;			//previously allocated chunk
+			size_t used;			//bytes handed out so far
+			size_t size;			//bytes available in text
+			char text[1];			//the strings, allocated past the end of the struct
+		};
+		static const size_t CHUNK_BYTES = 64 << 10;
+
+		Chunk* chunks;				//most recent chunk first
+		size_t chunkCount;			//chunks currently held
+		size_t heldBytes;			//bytes of chunk memory currently held
+		size_t liveBytes;			//bytes of strings still in use, prefix and NUL included
+		size_t deadBytes;			//bytes of strings replaced or released
+
+		TextArena(const TextArena&);			//not copyable, strings point into the arena
+		TextArena& operator=(const TextArena&);
+		static size_t footprint(size_t length);	//bytes a string of a given length takes in a chunk
+
+	public:
+		TextArena();
+		~TextArena();							//free every chunk
+		const char* add(const char* text, size_t length);	//copy a string into the arena
+		const char* add(const std::string& text);
+		void release(const char* text);			//count a string that is no longer used as dead
+		void merge(TextArena& other);			//take over the chunks of another arena, leaving it empty
+		void swap(TextArena& other);			//exchange the contents of two arenas
+		void clear();							//free every chunk at once
+
+		static size_t length(const char* text);	//length of a string of an arena, read from its prefix
+		static TextRef ref(const char* text);	//view of a string of an arena
+		static TextRef ref(const std::string& text);	//view of the characters of a std::string
+		size_t chunksHeld() const;				//chunks currently held, one heap allocation each
+		size_t bytes() const;					//bytes of chunk memory currently held
+		size_t live() const;					//bytes of strings in use
+		size_t dead() const;					//bytes of strings no longer in use
+};
+#endif
@@ -0,0 +1,606 @@
+//============================================================================
+// Name         : textindex.cpp
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  :
+//============================================================================
+#include "textindex.h" // Include the header file for the TextIndex class
+#include "book.h"
+#include <algorithm>
+using namespace std;
+
+// Constructor: an empty posting list
+TextIndex::Postings::Postings()
+{
+    head = 0;
+    count = 0;
+    last = 0;
+}
+
+// Method to add an id at the end of the list; it starts a new block every BLOCK ids
+void TextIndex::Postings::append(uint32_t id)
+{
+    if (count == 0)
+    {
+        head = id;
+    }
+    else if (count % BLOCK == 0) // The first id of a block goes in the skip table, uncompressed
+    {
+        skips.push_back(id);
+        skips.push_back(gaps.size());
+    }
+    else
+    {
+        if (gaps.capacity() == 0) gaps.reserve(8); // One allocation covers the few gaps of a rare word
+        uint32_t gap = id - last;
+        while (gap >= 0x80) // Seven bits per byte, the high bit marks a continuation
+        {
+            gaps.push_back(static_cast<uint8_t>(gap | 0x80));
+            gap >>= 7;
+        }
+        gaps.push_back(static_cast<uint8_t>(gap));
+    }
+    last = id;
+    count++;
+}
+
+// Method to get the number of blocks of the list
+int TextIndex::Postings::blocks() const
+{
+    return (count + BLOCK - 1) / BLOCK;
+}
+
+// Method to get the first id of a block
+uint32_t TextIndex::Postings::first(int block) const
+{
+    return block == 0 ? head : skips[2 * (block - 1)];
+}
+
+// Method to decode the ids of a block into a buffer of BLOCK ids
+int TextIndex::Postings::decode(int block, uint32_t* ids) const
+{
+    int size = (block == blocks() - 1) ? count - block * BLOCK : BLOCK; // Only the last block may be partial
+    const uint8_t* cursor = gaps.begin() + (block == 0 ? 0 : skips[2 * (block - 1) + 1]);
+    uint32_t id = first(block);
+    ids[0] = id;
+    for (int i = 1; i < size; ++i)
+    {
+        uint32_t gap = 0;
+        int shift = 0;
+        while (*cursor & 0x80)
+        {
+            gap |= static_cast<uint32_t>(*cursor++ & 0x7f) << shift;
+            shift += 7;
+        }
+        gap |= static_cast<uint32_t>(*cursor++) << shift;
+        id += gap;
+        ids[i] = id;
+    }
+    return size;
+}
+
+// A Cursor walks a posting list forward. seek() gallops over the skip table to the block
+// that may hold the target, so the blocks in between are never decoded.
+class TextIndex::Cursor
+{
+    private:
+        const Postings& list;
+        int block;                  //block currently decoded, -1 before the first seek
+        int position;               //position of the current id in the block
+        int size;                   //ids in the decoded block
+        uint32_t ids[BLOCK];        //the decoded block
+
+        void load(int next)
+        {
+            block = next;
+            size = list.decode(block, ids);
+            position = 0;
+        }
+
+    public:
+        Cursor(const Postings& list) : list(list), block(-1), position(0), size(0) {}
+
+        // Move to the first id not below target, return false if the list has none
+        bool seek(uint32_t target)
+        {
+            if (block < 0 || ids[size - 1] < target) // The target is past the decoded block
+            {
+                int blocks = list.blocks();
+                int low = (block < 0) ? 0 : block + 1; // Blocks before low end below the target
+                if (low >= blocks) return false;
+                if (list.first(low) <= target)
+                {
+                    // Gallop: double the step until a block starts past the target, then binary search
+                    int step = 1;
+                    while (low + step < blocks && list.first(low + step) <= target) step *= 2;
+                    int high = min(low + step, blocks); // first(high) > target, or high is the end
+                    low += step / 2;
+                    while (high - low > 1)
+                    {
+                        int middle = low + (high - low) / 2;
+                        if (list.first(middle) <= target) low = middle;
+                        else high = middle;
+                    }
+                }
+                load(low); // The last block starting at or before the target, or the first after it
+                if (ids[size - 1] < target) // The target falls between this block and the next
+                {
+                    if (low + 1 >= blocks) return false;
+                    load(low + 1);
+                }
+            }
+            position = lower_bound(ids + position, ids + size, target) - ids;
+            return true; // ids[size - 1] >= target, so position < size
+        }
+
+        uint32_t current() const { return ids[position]; }
+};
+
+// Constructor: an empty index
+TextIndex::TextIndex()
+{
+    liveBooks = 0;
+    gramBooks = 0;
+}
+
+// Helper function to tell the characters of a word: ASCII letters and digits, and every byte of a UTF-8 sequence
+static inline bool wordChar(unsigned char c)
+{
+    return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c >= 0x80;
+}
+
+// Helper method to lower-case a text in place and append a view of each of its words
+void TextIndex::tokenize(string& text, MyVector<TextRef>& out)
+{
+    char* data = &text[0];
+    size_t length = text.size(), i = 0;
+    while (i < length)
+    {
+        while (i < length && !wordChar(data[i])) i++; // Skip separators
+        size_t start = i;
+        for (; i < length && wordChar(data[i]); ++i)
+        {
+            if (data[i] >= 'A' && data[i] <= 'Z') data[i] += 'a' - 'A';
+        }
+        if (i == start) break;
+        TextRef word = { data + start, i - start };
+        out.push_back(word);
+    }
+}
+
+// Helper method to collect the distinct words of the title and the author of a book
+void TextIndex::collectWords(Book* book)
+{
+    text.assign(book->title, TextArena::length(book->title));
+    text += ' ';
+    text += *book->author;
+    words.clear();
+    tokenize(text, words);
+    sort(words.begin(), words.end());
+    int kept = unique(words.begin(), words.end()) - words.begin(); // A word in both fields is listed once
+    while (words.size() > kept) words.erase(words.size() - 1);
+}
+
+// Helper method to write the words of a text lower-cased and separated by single spaces
+void TextIndex::normalize(const char* text, size_t length, string& out)
+{
+    out.clear();
+    bool separated = false;
+    for (size_t i = 0; i < length; ++i)
+    {
+        char c = text[i];
+        if (!wordChar(c))
+        {
+            separated = true;
+            continue;
+        }
+        if (separated && !out.empty()) out += ' ';
+        separated = false;
+        out += (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 'a' - 'A') : c;
+    }
+}
+
+// Helper function to give a character of a normalized text its trigram code
+static inline int gramCode(char c)
+{
+    if (c == ' ') return 0;
+    if (c >= 'a' && c <= 'z') return 1 + (c - 'a');
+    if (c >= '0' && c <= '9') return 27 + (c - '0');
+    return 37; // Every byte of a UTF-8 sequence
+}
+
+// Helper method to list the distinct trigrams of a normalized text, padded with a space at each end
+void TextIndex::trigrams(const string& normalized, MyVector<uint32_t>& out)
+{
+    out.clear();
+    if (normalized.empty()) return;
+    int a = 0, b = gramCode(normalized[0]); // The padding space, then the first character
+    for (size_t i = 1; i <= normalized.size(); ++i)
+    {
+        int c = (i < normalized.size()) ? gramCode(normalized[i]) : 0; // The padding space ends the text
+        out.push_back((a * ALPHABET + b) * ALPHABET + c);
+        a = b;
+        b = c;
+    }
+    sort(out.begin(), out.end());
+    int kept = unique(out.begin(), out.end()) - out.begin();
+    while (out.size() > kept) out.erase(out.size() - 1);
+}
+
+// Helper method to count the insertions, deletions, substitutions and swaps of two adjacent
+// characters turning a into b (the optimal string alignment distance); it stops as soon as every
+// alignment is past bound and returns bound + 1
+int TextIndex::editDistance(const string& a, const string& b, int bound)
+{
+    int m = a.size(), n = b.size();
+    if (m - n > bound || n - m > bound) return bound + 1; // The length gap alone is too many edits
+    MyVector<int> before(n + 1), previous(n + 1), current(n + 1);
+    for (int j = 0; j <= n; ++j)
+    {
+        before.push_back(0);
+        previous.push_back(j);
+        current.push_back(0);
+    }
+    for (int i = 1; i <= m; ++i)
+    {
+        current[0] = i;
+        int best = i;
+        for (int j = 1; j <= n; ++j)
+        {
+            int cost = previous[j - 1] + (a[i - 1] != b[j - 1]);
+            cost = min(cost, min(previous[j], current[j - 1]) + 1);
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1])
+            {
+                cost = min(cost, before[j - 2] + 1); // The last two characters swapped
+            }
+            current[j] = cost;
+            best = min(best, cost);
+        }
+        if (best > bound) return bound + 1; // A row's minimum is at most one past the row before's, so no later row gets back under
+        swap(before, previous);
+        swap(previous, current);
+    }
+    return min(previous[n], bound + 1);
+}
+
+// Method to index a book under the words of its title and author
+void TextIndex::add(Book* book)
+{
+    if (book->textId != NONE) remove(book); // Indexed already, start over with its current fields
+    book->textId = books.size();
+    books.push_back(book);
+    liveBooks++;
+
+    collectWords(book);
+    for (int i = 0; i < words.size(); ++i)
+    {
+        unordered_map<TextRef, Postings, TextRefHash>::iterator it = lists.find(words[i]);
+        if (it == lists.end()) // A new word: keep a copy of it for the key
+        {
+            TextRef word = { wordText.add(words[i].text, words[i].length), words[i].length };
+            it = lists.emplace(word, Postings()).first;
+        }
+        it->second.append(book->textId); // Ids only grow, so every list stays sorted
+    }
+}
+
+// Helper method to add the titles indexed since the last fuzzy() to the trigram lists
+void TextIndex::indexGrams()
+{
+    if (grams.empty()) // The first fuzzy() lays out the table
+    {
+        grams.reserve(GRAMS);
+        for (int g = 0; g < GRAMS; ++g) grams.push_back(Postings());
+        for (int length = 0; length <= SHORT_TITLE; ++length) shortTitles.emplace_back();
+    }
+    for (; gramBooks < static_cast<uint32_t>(books.size()); ++gramBooks) // Ids only grow, so the lists stay sorted
+    {
+        Book* book = books[gramBooks];
+        if (book == nullptr) continue; // Removed before any fuzzy() saw it
+        normalize(book->title, TextArena::length(book->title), text);
+        trigrams(text, codes);
+        for (int i = 0; i < codes.size(); ++i)
+        {
+            grams[codes[i]].append(gramBooks);
+        }
+        if (text.size() <= static_cast<size_t>(SHORT_TITLE)) shortTitles[text.size()].push_back(gramBooks);
+    }
+}
+
+// Method to forget a book; its id stays in the lists, skipped by searches, until the next compaction
+void TextIndex::remove(Book* book)
+{
+    if (book->textId == NONE) return; // The book was never indexed
+    books[book->textId] = nullptr;
+    book->textId = NONE;
+    liveBooks--;
+
+    uint32_t dead = books.size() - liveBooks;
+    if (dead > 1024 && dead > liveBooks) compact(); // Mass removals: renumber instead of scanning dead ids forever
+}
+
+// Helper method to renumber the live books in their order and build the lists again
+void TextIndex::compact()
+{
+    MyVector<Book*> live;
+    live.reserve(liveBooks);
+    for (int i = 0; i < books.size(); ++i)
+    {
+        if (books[i] != nullptr) live.push_back(books[i]);
+    }
+    clear();
+    for (int i = 0; i < live.size(); ++i)
+    {
+        live[i]->textId = NONE;
+        add(live[i]);
+    }
+}
+
+// Method to forget every book; the books themselves are not touched, they may already be freed
+void TextIndex::clear()
+{
+    lists.clear();
+    wordText.clear();
+    grams.clear();
+    grams.shrink_to_fit();
+    shortTitles.clear();
+    shortTitles.shrink_to_fit();
+    hits.clear();
+    hits.shrink_to_fit();
+    books.clear();
+    books.shrink_to_fit();
+    liveBooks = 0;
+    gramBooks = 0;
+}
+
+// Helper method to find the ids of the books having every word of a group
+void TextIndex::intersect(const MyVector<TextRef>& group, MyVector<uint32_t>& out) const
+{
+    out.clear();
+    MyVector<const Postings*> found;
+    for (int i = 0; i < group.size(); ++i)
+    {
+        unordered_map<TextRef, Postings, TextRefHash>::const_iterator it = lists.find(group[i]);
+        if (it == lists.end()) return; // A word no book has, nothing matches
+        found.push_back(&it->second);
+    }
+    if (found.empty()) return;
+    sort(found.begin(), found.end(), [](const Postings* a, const Postings* b) { return a->count < b->count; });
+
+    // Start from the shortest list, then keep the candidates every other list has
+    uint32_t ids[BLOCK];
+    for (int b = 0; b < found[0]->blocks(); ++b)
+    {
+        int size = found[0]->decode(b, ids);
+        for (int i = 0; i < size; ++i) out.push_back(ids[i]);
+    }
+    for (int l = 1; l < found.size() && !out.empty(); ++l)
+    {
+        Cursor cursor(*found[l]);
+        int kept = 0;
+        for (int i = 0; i < out.size(); ++i)
+        {
+            if (!cursor.seek(out[i])) break; // The list ends before this candidate, and before the later ones
+            if (cursor.current() == out[i]) out[kept++] = out[i];
+        }
+        while (out.size() > kept) out.erase(out.size() - 1);
+    }
+}
+
+// Method to find the books matching a query: groups of words separated by OR, a book matches a
+// group if it has every word of it
+void TextIndex::search(const string& query, MyVector<Book*>& out) const
+{
+    out.clear();
+    MyVector<uint32_t> matches, group, merged;
+    size_t start = 0;
+    while (start <= query.size())
+    {
+        // Cut the next group at an OR that stands alone between spaces
+        size_t end = start;
+        while (end < query.size())
+        {
+            if (query.compare(end, 2, "OR") == 0 && (end == 0 || query[end - 1] == ' ') && (end + 2 == query.size() || query[end + 2] == ' ')) break;
+            end++;
+        }
+
+        string terms = query.substr(start, end - start);
+        MyVector<TextRef> words;
+        tokenize(terms, words);
+        if (!words.empty())
+        {
+            intersect(words, group);
+            merged.clear(); // Union with the groups before, both sides are sorted
+            merged.reserve(matches.size() + group.size());
+            int a = 0, b = 0;
+            while (a < matches.size() || b < group.size())
+            {
+                if (b == group.size() || (a < matches.size() && matches[a] < group[b])) merged.push_back(matches[a++]);
+                else if (a == matches.size() || group[b] < matches[a]) merged.push_back(group[b++]);
+                else { merged.push_back(matches[a++]); b++; } // In both, listed once
+            }
+            matches = move(merged);
+        }
+        start = end + 2;
+    }
+
+    for (int i = 0; i < matches.size(); ++i)
+    {
+        if (books[matches[i]] != nullptr) out.push_back(books[matches[i]]); // Skip removed books
+    }
+}
+
+// Method to find up to k titles within a few edits of a text. Candidates come from merging the
+// trigram lists, ranked by the trigrams they share; the best are checked with an edit distance.
+void TextIndex::fuzzy(const string& typed, int k, MyVector<Match>& out)
+{
+    indexGrams();
+    out.clear();
+    string query, title;
+    MyVector<uint32_t> queryGrams;
+    normalize(typed.data(), typed.size(), query);
+    trigrams(query, queryGrams);
+    if (queryGrams.empty() || grams.empty()) return;
+
+    // A title within bound edits keeps at least threshold of the query's trigrams, an insertion, deletion
+    // or substitution breaking at most three and a swap of two characters four
+    int bound = min(static_cast<int>(MAX_EDITS), 1 + static_cast<int>(query.size()) / 8);
+    int threshold = queryGrams.size() - 4 * bound;
+    if (threshold < 1) // A close title may share no trigram at all with the query
+    {
+        fuzzyShort(query, queryGrams, bound, k, out);
+        return;
+    }
+    MyVector<const Postings*> found;
+    for (int i = 0; i < queryGrams.size(); ++i) found.push_back(&grams[queryGrams[i]]);
+    sort(found.begin(), found.end(), [](const Postings* a, const Postings* b) { return a->count < b->count; });
+
+    // Missing threshold - 1 lists still leaves a title on one of the others, so merging the shortest
+    // ones finds every candidate. Merging a few more, up to four times as many ids, raises
+    // the hits a candidate needs among them and leaves fewer candidates to probe the long lists for.
+    int merged = found.size() - threshold + 1;
+    size_t mergedIds = 0;
+    for (int l = 0; l < merged; ++l) mergedIds += found[l]->count;
+    size_t budget = 4 * mergedIds;
+    while (merged < found.size() && mergedIds + found[merged]->count <= budget) mergedIds += found[merged++]->count;
+    int needed = threshold - (found.size() - merged);
+
+    // Count the hits of each id on the merged lists in a table indexed by id
+    if (hits.size() < books.size())
+    {
+        hits.reserve(books.size());
+        while (hits.size() < books.size()) hits.push_back(0);
+    }
+    MyVector<uint32_t> touched, ids;
+    uint32_t block[BLOCK];
+    for (int l = 0; l < merged; ++l)
+    {
+        for (int b = 0; b < found[l]->blocks(); ++b)
+        {
+            int size = found[l]->decode(b, block);
+            for (int i = 0; i < size; ++i)
+            {
+                if (hits[block[i]]++ == 0) touched.push_back(block[i]);
+            }
+        }
+    }
+    for (int i = 0; i < touched.size(); ++i)
+    {
+        if (hits[touched[i]] >= needed && books[touched[i]] != nullptr) ids.push_back(touched[i]); // Skip removed books
+    }
+    sort(ids.begin(), ids.end()); // The long lists are probed forward
+
+    // Probe the longer lists for each candidate, giving up once it cannot reach the threshold
+    MyVector<Match> candidates;
+    MyVector<Cursor> longer;
+    longer.reserve(found.size() - merged);
+    for (int l = merged; l < found.size(); ++l) longer.emplace_back(*found[l]);
+    for (int i = 0; i < ids.size(); ++i)
+    {
+        uint32_t id = ids[i];
+        int overlap = hits[id];
+        for (int l = 0; l < longer.size() && overlap + longer.size() - l >= threshold; ++l)
+        {
+            if (longer[l].seek(id) && longer[l].current() == id) overlap++;
+        }
+        if (overlap >= threshold)
+        {
+            Match match = { books[id], overlap, 0 };
+            candidates.push_back(match);
+        }
+    }
+    for (int i = 0; i < touched.size(); ++i) hits[touched[i]] = 0; // Clean for the next query
+
+    // Check the candidates sharing the most trigrams first, until k titles are close enough
+    stable_sort(candidates.begin(), candidates.end(), [](const Match& a, const Match& b) { return a.overlap > b.overlap; });
+    for (int i = 0; i < candidates.size() && out.size() < k; ++i)
+    {
+        normalize(candidates[i].book->title, TextArena::length(candidates[i].book->title), title);
+        candidates[i].distance = editDistance(query, title, bound);
+        if (candidates[i].distance <= bound) out.push_back(candidates[i]);
+    }
+    stable_sort(out.begin(), out.end(), [](const Match& a, const Match& b) { return a.distance < b.distance; });
+}
+
+// Helper method for a text whose trigrams could all be broken by bound edits: a title within bound
+// edits is within bound characters of the text's length, so the titles of those lengths are checked
+void TextIndex::fuzzyShort(const string& query, const MyVector<uint32_t>& queryGrams, int bound, int k, MyVector<Match>& out)
+{
+    MyVector<uint32_t> ids;
+    int shortest = max(1, static_cast<int>(query.size()) - bound), longest = query.size() + bound;
+    if (longest <= SHORT_TITLE)
+    {
+        for (int length = shortest; length <= longest; ++length)
+        {
+            for (int i = 0; i < shortTitles[length].size(); ++i) ids.push_back(shortTitles[length][i]);
+        }
+        sort(ids.begin(), ids.end()); // In the order the books were indexed
+    }
+    else // A long text repeating a few trigrams, rare enough to check every title
+    {
+        ids.reserve(books.size());
+        for (uint32_t id = 0; id < static_cast<uint32_t>(books.size()); ++id) ids.push_back(id);
+    }
+
+    string title;
+    for (int i = 0; i < ids.size(); ++i)
+    {
+        Book* book = books[ids[i]];
+        if (book == nullptr) continue; // Skip removed books
+        normalize(book->title, TextArena::length(book->title), title);
+        int distance = editDistance(query, title, bound);
+        if (distance > bound) continue;
+        trigrams(title, codes);
+        int overlap = 0, a = 0, b = 0; // Trigrams in both sorted lists
+        while (a < queryGrams.size() && b < codes.size())
+        {
+            if (queryGrams[a] < codes[b]) a++;
+            else if (codes[b] < queryGrams[a]) b++;
+            else { overlap++; a++; b++; }
+        }
+        Match match = { book, overlap, distance };
+        out.push_back(match);
+    }
+
+    // Closest first, then the titles sharing the most trigrams
+    stable_sort(out.begin(), out.end(), [](const Match& a, const Match& b) {
+        if (a.distance != b.distance) return a.distance < b.distance;
+        return a.overlap > b.overlap;
+    });
+    while (out.size() > k) out.erase(out.size() - 1);
+}
+
+// Method to get the number of distinct words
+size_t TextIndex::terms() const
+{
+    return lists.size();
+}
+
+// Method to get the number of books indexed
+size_t TextIndex::size() const
+{
+    return liveBooks;
+}
+
+// Method to estimate the memory of the index: hash nodes, words, posting lists and the id table
+size_t TextIndex::bytes() const
+{
+    size_t total = lists.bucket_count() * sizeof(void*) + books.capacity() * sizeof(Book*) + wordText.bytes();
+    for (unordered_map<TextRef, Postings, TextRefHash>::const_iterator it = lists.begin(); it != lists.end(); ++it)
+    {
+        total += sizeof(TextRef) + sizeof(Postings) + 2 * sizeof(void*); // Node: next link, cached hash, key and list
+        total += it->second.skips.capacity() * sizeof(uint32_t) + it->second.gaps.capacity();
+    }
+    total += grams.capacity() * sizeof(Postings);
+    for (int g = 0; g < grams.size(); ++g)
+    {
+        total += grams[g].skips.capacity() * sizeof(uint32_t) + grams[g].gaps.capacity();
+    }
+    for (int length = 0; length < shortTitles.size(); ++length)
+    {
+        total += sizeof(MyVector<uint32_t>) + shortTitles[length].capacity() * sizeof(uint32_t);
+    }
+    return total;
+}
@@ -0,0 +1,114 @@
+//============================================================================
+// Name         : textindex.h
+// Author       : Sebahadin Aman Denur
+// Version      :
+// Date Created : 0/5/04/2024
+// Date Modified:
+// Description  : Inverted index over the words of titles and authors
+//============================================================================
+#ifndef _TEXTINDEX_H
+#define _TEXTINDEX_H
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<unordered_map>
+#include "myvector.h"
+#include "textarena.h"
+class Book;
+
+// A TextIndex maps every word of the titles and authors of the catalog to the books that
+// contain it. Words are runs of letters and digits, compared without case. Each book gets
+// a 32-bit id when it is indexed, and ids only grow, so a posting list is extended at its
+// end. A list is stored in blocks of BLOCK ids: the first id of each block goes in a skip
+// table (the first block's in the list itself, as most words are rare), and the gaps to
+// the next ids are varint-encoded behind it. A removed book keeps its id in the lists
+// until more than half of the ids are dead; then the index renumbers the live books and
+// builds its lists again.
+//
+// The index also keeps a list per trigram of the titles. A title is lower-cased, its runs
+// of separators become one space, and it is padded with a space at each end; every three
+// consecutive characters then make a trigram. Letters, digits and the space get codes of
+// their own and every other byte shares one, so the lists sit in a flat table indexed by
+// code instead of a hash table. They are filled by fuzzy(), with the books indexed since
+// its last call, so imports do not pay for them until someone makes a fuzzy search. Titles
+// of at most SHORT_TITLE characters once normalized are also listed by their length.
+//
+// search() takes words separated by spaces, all of which must match, and OR between
+// groups of words, any of which may match: "knuth art OR taocp" is (knuth AND art) OR
+// taocp. A group is answered by intersecting its lists, shortest first; the longer lists
+// are searched by galloping over their skip tables, so only the blocks that can hold a
+// candidate are decoded. fuzzy() finds titles a few typing errors away from a text, an error
+// being a character inserted, dropped or replaced, or two adjacent characters swapped. A
+// title within d errors of the text shares all but at most 4d of its trigrams, so a candidate
+// has to be on one of the shortest lists, which are merged, and the longer lists are only
+// probed for those candidates. Candidates are ranked by the trigrams they share and the
+// best ones are checked with an edit distance that gives up past d. A text of 4d trigrams or
+// fewer may share none with a close title; its matches are looked for among the titles whose
+// length is within d of its own.
+class TextIndex
+{
+	public:
+		static const uint32_t NONE = 0xffffffff;	//id of a book that is not indexed
+		struct Match
+		{
+			Book* book;
+			int overlap;					//trigrams the title shares with the text
+			int distance;					//edits from the text to the title
+		};
+
+	private:
+		static const int BLOCK = 128;		//ids per block of a posting list
+		static const int ALPHABET = 38;		//trigram character codes: space, 26 letters, 10 digits, any other byte
+		static const int GRAMS = ALPHABET * ALPHABET * ALPHABET;
+		static const int MAX_EDITS = 3;		//largest edit distance fuzzy() accepts
+		static const int SHORT_TITLE = 15;	//longest normalized title listed by length
+		struct Postings
+		{
+			MyVector<uint32_t> skips;		//first id and byte offset of every block after the first
+			MyVector<uint8_t> gaps;			//varint gaps between the ids of a block after its first
+			uint32_t head;					//first id of the list, most words never need a skip table
+			uint32_t count;					//ids in the list, removed books included
+			uint32_t last;					//largest id in the list
+
+			Postings();
+			void append(uint32_t id);		//add an id larger than every id in the list
+			int blocks() const;				//number of blocks
+			uint32_t first(int block) const;	//first id of a block
+			int decode(int block, uint32_t* ids) const;	//decode a block, return its number of ids
+		};
+		class Cursor;						//walks a posting list forward, skipping whole blocks
+
+		std::unordered_map<TextRef, Postings, TextRefHash> lists;	//word -> books containing it, keyed by a word in wordText
+		TextArena wordText;					//the distinct words, each stored once
+		MyVector<Book*> books;				//id -> book, nullptr once the book was removed
+		uint32_t liveBooks;					//books currently indexed
+		std::string text;					//scratch copy of the title and author of one book, lower-cased
+		MyVector<TextRef> words;			//scratch list of the words of one book, views of text
+		MyVector<Postings> grams;			//trigram code -> books whose title has it, empty until the first fuzzy()
+		uint32_t gramBooks;					//ids below this one are in the trigram lists
+		MyVector<uint16_t> hits;			//scratch count of trigram hits per id, zero between queries
+		MyVector<uint32_t> codes;			//scratch list of the trigrams of one title
+		MyVector<MyVector<uint32_t> > shortTitles;	//normalized length -> ids of the titles that long, up to SHORT_TITLE, filled with the trigram lists
+
+		static void tokenize(std::string& text, MyVector<TextRef>& out);	//lower-case a text in place and append views of its words
+		void collectWords(Book* book);		//fill words with the distinct words of a book
+		void intersect(const MyVector<TextRef>& group, MyVector<uint32_t>& out) const;	//ids of the books having every word
+		void compact();						//renumber the live books and rebuild every list
+		void indexGrams();					//add the titles indexed since the last fuzzy() to the trigram lists
+		static void normalize(const char* text, size_t length, std::string& out);	//lower-case words separated by single spaces
+		static void trigrams(const std::string& normalized, MyVector<uint32_t>& out);	//distinct trigram codes of a normalized text, sorted
+		void fuzzyShort(const std::string& query, const MyVector<uint32_t>& queryGrams, int bound, int k, MyVector<Match>& out);	//fuzzy() for a text with too few trigrams to filter on
+		static int editDistance(const std::string& a, const std::string& b, int bound);	//edits from a to b, swaps of adjacent characters included, bound + 1 once past bound
+
+	public:
+		TextIndex();
+		void add(Book* book);				//index the title and author of a book
+		void remove(Book* book);			//forget a book, its ids stay in the lists until the next compaction
+		void clear();						//forget every book
+		void search(const std::string& query, MyVector<Book*>& out) const;	//books matching a query, in the order they were indexed
+		void fuzzy(const std::string& typed, int k, MyVector<Match>& out);	//up to k titles within a few edits of a text, closest first
+		size_t terms() const;				//distinct words
+		size_t size() const;				//books indexed
+		size_t bytes() const;				//memory of the posting lists, words and id table
+};
+#endif
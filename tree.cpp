@@ -10,57 +10,65 @@
 #include "tree.h" 
 #include <fstream> 
 #include <iostream> 
+#include <cstring>
+#include <memory>
+#include <thread>
+#include "scheduler.h"
+
+StringPool Node::names; // Shared by every node of every catalog
 
 // Constructor for a Node object, initializing with a given name
 Node :: Node(string name)
 {
-	this->name = name; // Set the name of the node
+	this->name = names.intern(name); // Set the name of the node to the pool's copy
 	this->parent = nullptr; // Initially, this node has no parent
 	this->bookCount = 0; // Initialize the book count to 0
+	this->flatId = FlatTree::NONE; // Not laid out yet
+	this->pathGeneration = 0;
+	this->pathFor = STALE; // The path is built on first use
 }
 
 // Method to get the category path for a node
 string Node::getCategory(Node* node)
 {
-    if (node->parent == nullptr) return ""; // If the node has no parent, return an empty string
-
-    string path = node->name; // Start with the name of the current node
-    // Iterate upwards through the tree, prepending each parent's name to the path
-    while (node->parent != nullptr && node->parent->parent != nullptr)
-    {
-        node = node->parent; // Move to the parent node
-        path = node->name + "/" + path; // Prepend the parent's name to the path
-    }
-
-    return path; // Return the computed path
+    return node->cachedPath(); // A copy of the cached path
 }
 
-// Destructor for a Node, responsible for cleaning up dynamically allocated memory
-Node :: ~Node()
+// Method to get the cached category path of the node. The cache is valid while it was built from
+// the parent's current path; a rename marks the renamed node stale, and rebuilding it bumps its
+// generation, so each descendant rebuilds its own path once, on its next use
+const string& Node::cachedPath()
 {
-    // Delete all dynamically allocated child nodes
-	for(int i = 0 ; i < this->children.size(); i ++)
-	{
-		delete this->children[i]; // Delete each child node
-	}
+    if (parent == nullptr) return path; // The root's path is empty and never changes
 
-    // Delete all dynamically allocated books
-	for(int i = 0 ; i < this->books.size(); i ++)
-	{
-		delete this->books[i]; // Delete each book
-	}
+    const string& parentPath = parent->cachedPath(); // Makes the parent's generation current
+    if (pathFor != parent->pathGeneration)
+    {
+        if (parent->parent == nullptr) // The root's name is not part of any path
+        {
+            path = *name;
+        }
+        else
+        {
+            path.reserve(parentPath.size() + 1 + name->size());
+            path.assign(parentPath).append(1, '/').append(*name);
+        }
+        pathFor = parent->pathGeneration;
+        pathGeneration++; // The children's caches were built from the old path
+    }
+    return path;
 }
 
 // Constructor for the Tree class, initializing with a root node name
 Tree :: Tree(string rootName)
 {
-    root = new Node(rootName); // Create a new Node as the root of the tree
+    root = nodePool.create(rootName); // Create a new Node as the root of the tree
+    generation = 0; // The flat layout has never been built, so it is stale
 }
 
-// Destructor for the Tree class, cleans up the root node
+// Destructor for the Tree class: the pools free every node and book, slab by slab
 Tree :: ~Tree()
 {
-    delete this->root; // Delete the root node, freeing its memory
 }
 
 // Method to get the root node of the tree
@@ -69,30 +77,62 @@ Node* Tree :: getRoot()
 	return this->root; // Return a pointer to the root node
 }
 
-// Method to insert a new child node under a given parent node
-void Tree :: insert(Node* node, string name)
-{	
-    bool exists = false; // Flag to track if the child already exists
-	for (int i = 0; i < node->children.size(); ++i) // Iterate over existing children
+// Method to get the pool the nodes of the tree come from
+Pool<Node>& Tree :: getNodePool()
+{
+	return this->nodePool;
+}
+
+// Method to get the pool the books of the tree come from
+Pool<Book>& Tree :: getBookPool()
+{
+	return this->bookPool;
+}
+
+// Method to get the arena the titles of the tree's books are stored in
+TextArena& Tree :: getTitleArena()
+{
+	return this->titleArena;
+}
+
+// Method to get the flat layout of the tree, laying it out again if the tree changed since
+const FlatTree& Tree :: layout()
+{
+	if (!flat.isCurrent(generation)) flat.build(root, generation); // One pass over the pointer tree
+	return flat;
+}
+
+// Recursive helper method to return the nodes and books of a subtree to the pools
+void Tree :: destroy_helper(Node* node)
+{
+	for (int i = 0; i < node->children.size(); i++)
 	{
-		if(node->children[i]->name == name) 
-		{
-			exists = true; // Mark as exists if found
-			break;
-		}
+		destroy_helper(node->children[i]); // Free each child subtree
 	}
+	for (int i = 0; i < node->books.size(); i++)
+	{
+		titleArena.release(node->books[i]->title); // The title's bytes are dead until the catalog is reloaded
+		bookPool.destroy(node->books[i]); // Recycle each book
+	}
+	nodePool.destroy(node);
+}
 
+// Method to insert a new child node under a given parent node
+void Tree :: insert(Node* node, string name)
+{	
     // If the child does not already exist, add it
-	if (!exists)
+	if (node->childIndex.find(name) == node->childIndex.end())
 	{
-		Node* temp = new Node(name); // Create a new node
+		Node* temp = nodePool.create(name); // Create a new node
 		temp->parent = node; // Set the parent of the new node
 		node->children.push_back(temp); // Add the new node to the parent's children vector
+		node->childIndex[name] = temp; // Index the new node by its name
+		generation++; // The flat layout is missing the new node
 	}
 	else
 	{
 	    // If the child already exists, throw an error
-		throw runtime_error("child with name " + name + " already exists in " + node->name);
+		throw runtime_error("child with name " + name + " already exists in " + *node->name);
 	}
 }
 
@@ -100,46 +140,81 @@ void Tree :: insert(Node* node, string name)
 void Tree::remove(Node* node, string child_name) {
     if (node != nullptr) // Ensure the parent node is not null
     {
-        bool found = false; // Flag to indicate if the child is found
-        for (int i = 0; i < node->children.size(); i++) // Iterate over the children
+        unordered_map<string, Node*>::iterator it = node->childIndex.find(child_name);
+        if (it == node->childIndex.end()) { // If the child is not found, throw an error
+            throw runtime_error("Child with name " + child_name + " not found!");
+        }
+        Node* child = it->second;
+
+        // Update bookCount for the node (parent of the child being removed) and all its ancestors
+        int decrementCount = child->bookCount;
+        Node* toUpdate = node; // Start from the parent node
+        while (toUpdate != nullptr) 
         {
-            if (node->children[i]->name == child_name) // Check if the child's name matches
+            toUpdate->bookCount -= decrementCount; // Decrement the book count
+            toUpdate = toUpdate->parent; // Move to the parent node
+        }
+
+        // Unlink the child, keeping the order of its siblings for printing
+        for (int i = 0; i < node->children.size(); i++)
+        {
+            if (node->children[i] == child) // Pointer compare, no string compares needed
             {
-                // Calculate the total book count to be decremented
-                int decrementCount = node->children[i]->bookCount;
-
-                // Update bookCount for the node (parent of the child being removed) and all its ancestors
-                Node* toUpdate = node; // Start from the parent node
-                while (toUpdate != nullptr) 
-                {
-                    toUpdate->bookCount -= decrementCount; // Decrement the book count
-                    toUpdate = toUpdate->parent; // Move to the parent node
-                }
-
-                // Remove the child node and free its memory
-                delete node->children[i]; // Free the memory of the node being removed
                 node->children.erase(i); // Erase the child from the vector
-                found = true; // Mark as found
-                break; // Exit after removing the child
+                generation++; // The flat layout still holds the subtree
+                break;
             }
         }
-        if (!found) { // If the child is not found, throw an error
-            throw runtime_error("Child with name " + child_name + " not found!");
-        }
+        node->childIndex.erase(it); // Drop the child from the index
+        pathCache.clear(); // Cached paths may point into the deleted subtree; they are re-resolved on demand
+        destroy_helper(child); // Recycle the nodes and books of the removed subtree
     }
 }
 
+// Method to rename a node, rekeying it in its parent's child index
+void Tree::rename(Node* node, string new_name)
+{
+    if (node == nullptr || node == root) // The root has no parent index to update
+    {
+        throw runtime_error("Category does not exist");
+    }
+    if (new_name == *node->name) return; // Nothing to do
+
+    Node* parent = node->parent;
+    if (parent->childIndex.find(new_name) != parent->childIndex.end())
+    {
+        throw runtime_error("child with name " + new_name + " already exists in " + *parent->name);
+    }
+    parent->childIndex.erase(*node->name); // Drop the old key
+    node->name = Node::names.intern(new_name); // Update the name of the node
+    node->pathFor = Node::STALE; // The node's path and, through its generation, its descendants' are rebuilt on use
+    parent->childIndex[new_name] = node; // Index the node under its new name
+    pathCache.clear(); // Every cached path through the renamed node is now stale
+}
+
 // Method to check if a given node is the root of the tree
 bool Tree :: isRoot(Node* node)
 {
 	return node == this->root; // Return true if the node is the root, false otherwise
 }
 
+// Helper function to strip the leading '/' of a path so "/A/B" and "A/B" share a cache entry
+static const string& normalizePath(const string& path, string& storage)
+{
+    if (path.empty() || path[0] != '/') return path; // Common case: use the caller's string as is
+    storage = path.substr(1);
+    return storage;
+}
+
 // Method to find a node given a path in the format category/sub-category/...
-Node* Tree::getNode(string path) 
+Node* Tree::getNode(const string& category) 
 {
-    int start = 0, end; // Initialize indices for parsing the path
-    if (path[start] == '/') start++; // Skip the leading '/' if present
+    string trimmed; // Only used when the path has to be normalized
+    const string& path = normalizePath(category, trimmed);
+    unordered_map<string, Node*>::iterator cached = pathCache.find(path);
+    if (cached != pathCache.end()) return cached->second; // Repeated lookups cost a single hash probe
+
+    int start = 0, end; // Initialize indices for parsing the path (the leading '/' is already gone)
 
     end = path.find('/', start); // Find the first '/' to delimit the first segment
     string segment; // String to hold each path segment
@@ -152,17 +227,8 @@ Node* Tree::getNode(string path)
     Node* node = root; // Start from the root node
 
     do {
-        bool exists = false; // Flag to check if the segment exists among the node's children
-        for (size_t i = 0; i < node->children.size(); ++i)
-        { 
-            if (node->children[i]->name == segment) 
-            {
-                node = node->children[i]; // If the segment matches a child, move to that child
-                exists = true; // Mark as exists
-                break; // Break the loop since the segment was found
-            }
-        }
-        if (!exists) return nullptr; // If the segment is not found, return nullptr
+        node = getChild(node, segment); // Look the segment up in the child index
+        if (node == nullptr) return nullptr; // If the segment is not found, return nullptr
 
         if (end == string::npos) break; // If there are no more segments, exit the loop
 
@@ -178,14 +244,19 @@ Node* Tree::getNode(string path)
         }
     } while (true);
 
+    pathCache[path] = node; // Remember the resolved path
     return node; // Return the node found at the end of the path
 }
 
 // Method to create a node given a path, creating intermediate nodes as necessary
-Node* Tree::createNode(string path)
+Node* Tree::createNode(const string& category)
 {
-    int start = 0, end; // Initialize indices for parsing the path
-    if (path[start] == '/') start++; // Skip the leading '/' if present
+    string trimmed; // Only used when the path has to be normalized
+    const string& path = normalizePath(category, trimmed);
+    unordered_map<string, Node*>::iterator cached = pathCache.find(path);
+    if (cached != pathCache.end()) return cached->second; // Repeated lookups cost a single hash probe
+
+    int start = 0, end; // Initialize indices for parsing the path (the leading '/' is already gone)
 
     end = path.find('/', start); // Find the first '/' to delimit the first segment
     string segment; // String to hold each path segment
@@ -198,21 +269,13 @@ Node* Tree::createNode(string path)
     Node* node = root; // Start from the root node
 
     do {
-        bool exists = false; // Flag to check if the segment exists among the node's children
-        for (int i = 0; i < node->children.size(); ++i)
-        { 
-            if (node->children[i]->name == segment) 
-            {
-                node = node->children[i]; // If the segment matches a child, move to that child
-                exists = true; // Mark as exists
-                break; // Break the loop since the segment was found
-            }
-        }
-        if (!exists) // If the segment is not found among children, create it
+        Node* child = getChild(node, segment); // Look the segment up in the child index
+        if (child == nullptr) // If the segment is not found among children, create it
         {
             insert(node, segment); // Insert a new child node for the segment
-            node = node->children[node->children.size()-1]; // Move to the newly created child
+            child = node->children[node->children.size()-1]; // Move to the newly created child
         }
+        node = child;
 
         if (end == string::npos) break; // If there are no more segments, exit the loop
 
@@ -228,22 +291,15 @@ Node* Tree::createNode(string path)
         }
     } while (true);
 
+    pathCache[path] = node; // Remember the resolved path
     return node; // Return the node found or created at the end of the path
 }
 
 // Method to get a child node by name from a given parent node
 Node* Tree::getChild(Node *ptr, string childname)
 {
-	Node* ch_ptr = nullptr; // Initialize a pointer to hold the found child
-	for(int i = 0; i < ptr->children.size(); i++)
-	{
-		if(ptr->children[i]->name == childname) // Check if the child's name matches the given name
-		{	
-			ch_ptr = ptr->children[i]; // Set the pointer to the found child
-			break; // Exit the loop since the child was found
-		}
-	}
-	return ch_ptr; // Return the found child, or nullptr if not found
+	unordered_map<string, Node*>::iterator it = ptr->childIndex.find(childname); // Probe the child index
+	return (it == ptr->childIndex.end()) ? nullptr : it->second; // Return the found child, or nullptr if not found
 } 
 
 // Method to update the book count of a node by a given offset
@@ -255,13 +311,33 @@ void Tree :: updateBookCount(Node *ptr, int offset)
 	} else throw runtime_error("couldn't update bookCount, category does not exist!");
 }
 
+// Method to recompute every book count after a bulk load: the books of a subtree are one
+// range of the flat layout, so each count is a subtraction
+void Tree :: recountBooks()
+{
+	const FlatTree& flat = layout();
+	for (uint32_t id = 0; id < flat.size(); id++)
+	{
+		flat[id].node->bookCount = flat.subtreeBooks(id);
+	}
+}
+
+// Method to append a book to a node and link the book to it; the book must come from the tree's book pool
+void Tree :: addBook(Node* node, Book* book)
+{
+	book->node = node; // Remember the category that holds the book
+	node->books.push_back(book); // The tree owns the book from here on
+	generation++; // The flat layout is missing the book
+}
+
 // Method to find a book by title in a given node
 Book* Tree :: findBook(Node *node, string bookTitle)
 {
 	Book* b_ptr = nullptr; // Initialize a pointer to hold the found book
 	for (int i = 0; i < node->books.size(); ++i) // Iterate over the books in the node
 	{
-		if(node->books[i]->title == bookTitle) // Check if the book's title matches the given title
+		const char* title = node->books[i]->title;
+		if(TextArena::length(title) == bookTitle.size() && memcmp(title, bookTitle.data(), bookTitle.size()) == 0) // Check if the book's title matches the given title
 			{
 				b_ptr = node->books[i]; // Set the pointer to the found book
 				break; // Exit the loop since the book was found
@@ -270,14 +346,16 @@ Book* Tree :: findBook(Node *node, string bookTitle)
 	return b_ptr; // Return the found book, or nullptr if not found
 }
 
-// Method to remove a book by title from a given node
-bool Tree::removeBook(Node* node, string bookTitle) {
+// Method to remove a book from a given node
+bool Tree::removeBook(Node* node, Book* book) {
     if (node == nullptr) return false; // If the node is null, indicate the book was not removed
 
     for (int i = 0; i < node->books.size(); ++i) { // Iterate over the books in the node
-        if (node->books[i]->title == bookTitle) { // Check if the book's title matches the given title
-            delete node->books[i]; // Free the memory allocated for the book
+        if (node->books[i] == book) { // Remove this very book, even if the category holds another with its title
+            titleArena.release(book->title); // The title's bytes are dead until the catalog is reloaded
+            bookPool.destroy(node->books[i]); // Recycle the book's slot
             node->books.erase(i); // Remove the book from the vector
+            generation++; // The flat layout still holds the book
             
             // Update the book count for the node and all its ancestors
             Node* current = node;
@@ -292,39 +370,111 @@ bool Tree::removeBook(Node* node, string bookTitle) {
     return false; // Indicate the book was not found and therefore not removed
 }
 
-// Recursive method to print all books of a node and its children
-void Tree :: printAll(Node *node)   
+// Helper function to append the decimal digits of a number, without the temporary string of to_string
+static void appendInt(string& out, int value)
+{
+	char digits[12]; // A sign and ten digits
+	char* end = digits + sizeof(digits);
+	char* cursor = end;
+	unsigned int magnitude = (value < 0) ? 0u - static_cast<unsigned int>(value) : static_cast<unsigned int>(value);
+	do
+	{
+		*--cursor = static_cast<char>('0' + magnitude % 10); // Digits from the last one
+		magnitude /= 10;
+	} while (magnitude != 0);
+	if (value < 0) *--cursor = '-';
+	out.append(cursor, end - cursor);
+}
+
+// Helper function to append a title of the arena, whose length is stored in front of it
+static void appendTitle(string& out, const char* title)
+{
+	out.append(title, TextArena::length(title));
+}
+
+// Helper function to start loading the books a formatter reaches next: the books of a category
+// were created in import order and are scattered over the pool, so a scan would otherwise wait
+// for memory at every book and again at its title
+static void prefetchAhead(const FlatTree& flat, uint32_t i, uint32_t end)
+{
+	if (i + 8 < end) __builtin_prefetch(flat.book(i + 8));
+	if (i + 4 < end) __builtin_prefetch(flat.book(i + 4)->getTitle() - sizeof(uint32_t)); // Its record was fetched four books ago
+}
+
+// Method to print all books of a node and its children: in pre-order the books of a subtree
+// are one range of the flat layout, the node's own books first
+void Tree :: printAll(Node *node, int threads)   
 { 
-    // If the node is a leaf node (no children), print its books
-	if (node->children.size() == 0)
+	writeSubtree(node, threads, formatBooks, cout);
+}
+
+// Helper method to format a range of books the way findAll prints them
+void Tree :: formatBooks(const FlatTree& flat, uint32_t begin, uint32_t end, string& out)
+{
+	for (uint32_t i = begin; i < end; ++i)
 	{
-        // Iterate over the books and print their details
-		for (int i = 0; i < node->books.size(); ++i)
-		{
-			cout << "Title: " << node->books[i]->title << endl;
-			cout << "Author(s): " << node->books[i]->author << endl;
-			cout << "ISBN: " << node->books[i]->isbn << endl;
-			cout << "Year: " << node->books[i]->publication_year << endl;
-			cout << "=====================================================================================================" << endl;
-		}
+		prefetchAhead(flat, i, end);
+		Book* book = flat.book(i);
+		out.append("Title: ");
+		appendTitle(out, book->title);
+		out.append("\nAuthor(s): ").append(*book->author).append("\nISBN: ");
+		book->isbn.appendTo(out);
+		out.append("\nYear: ");
+		appendInt(out, book->publication_year);
+		out.push_back('\n');
+		out.append("=====================================================================================================\n");
 	}
-	else
+}
+
+// Helper function to write the buffers of a wave in book order
+static void writeWave(ostream* out, const string* buffers, int count)
+{
+	for (int t = 0; t < count; ++t)
 	{
-        // If the node has children, print its books and then recursively print the books of its children
-		for (int i = 0; i < node->books.size(); ++i)
-		{
-			cout << "Title: " << node->books[i]->title << endl;
-			cout << "Author(s): " << node->books[i]->author << endl;
-			cout << "ISBN: " << node->books[i]->isbn << endl;
-			cout << "Year: " << node->books[i]->publication_year << endl;
-			cout << "=====================================================================================================" << endl;
-		}
-		for(int i = 0; i < node->children.size(); i++)
-		{
-			printAll(node->children[i]); // Recursively print the books of each child
-		}
+		out->write(buffers[t].data(), buffers[t].size()); // One large write per task, whichever thread formatted it
+	}
+}
 
+// Guard that waits for the writer of the previous wave, also when formatting a wave throws
+struct WaveWriter
+{
+	thread writer;
+	void wait() { if (writer.joinable()) writer.join(); }
+	~WaveWriter() { wait(); }
+};
+
+// Helper method to format the books of a subtree on a number of threads and write them in pre-order.
+// The range is cut into tasks of TASK_BOOKS books, each formatted into a buffer of its own. A wave
+// of tasks is formatted at a time; with several threads the waves alternate between two sets of
+// buffers, and a writer thread writes one wave while the next is being formatted.
+uint32_t Tree :: writeSubtree(Node* node, int threads, Formatter format, ostream& out)
+{
+	const FlatTree& flat = layout();
+	uint32_t begin = flat.bookBegin(node->flatId), end = flat.bookEnd(node->flatId);
+	int waveTasks = (threads > 1) ? threads * TASKS_PER_THREAD : 1;
+	unique_ptr<string[]> buffers(new string[2 * waveTasks]); // Reused by every other wave, they keep their capacity
+	WaveWriter pending;
+
+	int wave = 0;
+	for (uint32_t first = begin; first < end; wave++)
+	{
+		uint32_t waveEnd = (end - first > static_cast<uint64_t>(waveTasks) * TASK_BOOKS) ? first + waveTasks * TASK_BOOKS : end;
+		int tasks = (waveEnd - first + TASK_BOOKS - 1) / TASK_BOOKS;
+		string* waveBuffers = &buffers[(wave % 2) * waveTasks]; // Not the set the writer may still be writing
+		Scheduler::run(tasks, threads, [&](int t) {
+			uint32_t taskBegin = first + t * TASK_BOOKS;
+			uint32_t taskEnd = (waveEnd - taskBegin > TASK_BOOKS) ? taskBegin + TASK_BOOKS : waveEnd;
+			waveBuffers[t].clear();
+			format(flat, taskBegin, taskEnd, waveBuffers[t]);
+		});
+		pending.wait(); // The previous wave goes out first
+		if (threads > 1) pending.writer = thread(writeWave, &out, waveBuffers, tasks);
+		else writeWave(&out, waveBuffers, tasks); // A single thread gains nothing from a writer
+		first = waveEnd;
 	}
+	pending.wait();
+	out.flush();
+	return end - begin;
 }
 
 // Method to check if a node is the last child of its parent
@@ -336,6 +486,32 @@ bool Tree :: isLastChild(Node *ptr)
     return false; // Otherwise, return false
 }
 
+// Method to compare two nodes in pre-order: walk both up to the children of their lowest common
+// ancestor and compare the positions of those; costs the depth plus one list of siblings
+bool Tree :: precedes(Node* a, Node* b)
+{
+    int depthA = 0, depthB = 0;
+    for (Node* n = a; n->parent != nullptr; n = n->parent) depthA++;
+    for (Node* n = b; n->parent != nullptr; n = n->parent) depthB++;
+    Node* upA = a;
+    Node* upB = b;
+    while (depthA > depthB) { upA = upA->parent; depthA--; }
+    while (depthB > depthA) { upB = upB->parent; depthB--; }
+    if (upA == upB) return upA == a && a != b; // One is an ancestor of the other, which comes first
+    while (upA->parent != upB->parent)
+    {
+        upA = upA->parent;
+        upB = upB->parent;
+    }
+    MyVector<Node*>& siblings = upA->parent->children;
+    for (int i = 0; i < siblings.size(); i++)
+    {
+        if (siblings[i] == upA) return true; // The branch of a is met first
+        if (siblings[i] == upB) return false;
+    }
+    return false;
+}
+
 // Method to print the entire tree structure
 void Tree :: print()
 {
@@ -347,7 +523,7 @@ void Tree :: print_helper(string padding, string pointer, Node *node)
 {
     if (node != nullptr) // Ensure the node is not null
     {
-        cout << padding << pointer << node->name << "(" << node->bookCount << ")" << endl; // Print the current node
+        cout << padding << pointer << *node->name << "(" << node->bookCount << ")" << endl; // Print the current node
 
         if(node != root)	padding += (isLastChild(node)) ? "   " : "│  "; // Adjust the padding based on whether the node is the last child
 
@@ -360,36 +536,53 @@ void Tree :: print_helper(string padding, string pointer, Node *node)
     }
 }
 
-// Method to export all books of a given node to a specific file
-int Tree::exportData(Node* node, ofstream& file) {
+// Method to export all books of a given node and its children to a specific file, sweeping the
+// books of the subtree in pre-order on a number of threads
+int Tree::exportData(Node* node, ofstream& file, int threads) {
     if (!node) return 0; // If the node is null, return 0 indicating no books were exported
 
-    string category = node->getCategory(node); // Get the category path for the node
-    int count = 0; // Initialize a counter for the number of books exported
+    // Refresh the cached paths of the subtree before the threads start, so the formatters only read them;
+    // in pre-order every parent is refreshed before its children, and each refresh is one concatenation
+    const FlatTree& flat = layout();
+    for (uint32_t id = node->flatId; id < flat[node->flatId].subtreeEnd; ++id) {
+        flat[id].node->cachedPath();
+    }
+    return writeSubtree(node, threads, formatRows, file);
+}
+
+// Helper method to format a range of books as CSV rows; the category paths of the nodes are
+// cached and already current (see exportData)
+void Tree :: formatRows(const FlatTree& flat, uint32_t begin, uint32_t end, string& out)
+{
+    for (uint32_t i = begin; i < end; ++i) {
+        prefetchAhead(flat, i, end);
+        Book* book = flat.book(i);
+        const string& category = book->node->path; // Read only, several threads share the node
 
-    // Iterate over the books in the node and export their details to the file
-    for (int i = 0; i < node->books.size(); ++i) {
         // Output the title, handling commas by enclosing in quotes if necessary
-        if (node->books[i]->title.find(',') != string::npos) {
-            file << '"' << node->books[i]->title << '"' << ',';
+        size_t titleLength = TextArena::length(book->title);
+        if (memchr(book->title, ',', titleLength) != nullptr) {
+            out.push_back('"');
+            out.append(book->title, titleLength).append("\",");
         } else {
-            file << node->books[i]->title << ',';
+            out.append(book->title, titleLength).push_back(',');
         }
 
         // Output the author, handling commas by enclosing in quotes if necessary
-        if (node->books[i]->author.find(',') != string::npos) {
-            file << '"' << node->books[i]->author << '"' << ',';
+        if (book->author->find(',') != string::npos) {
+            out.push_back('"');
+            out.append(*book->author).append("\",");
         } else {
-            file << node->books[i]->author << ',';
+            out.append(*book->author).push_back(',');
         }
 
-        file << node->books[i]->isbn << ','; // Output the ISBN
-        file << to_string(node->books[i]->publication_year) << ',' << "," << category << ','; // Output the publication year and category
-        file << to_string(node->books[i]->total_copies) << ','; // Output the total copies
-        file << to_string(node->books[i]->available_copies) << endl; // Output the available copies and move to the next line
-
-        count++; // Increment the counter for each book exported
+        book->isbn.appendTo(out); // Output the ISBN
+        out.push_back(',');
+        appendInt(out, book->publication_year); // Output the publication year and category
+        out.append(",,").append(category).push_back(',');
+        appendInt(out, book->total_copies); // Output the total copies
+        out.push_back(',');
+        appendInt(out, book->available_copies); // Output the available copies and move to the next line
+        out.push_back('\n');
     }
-
-    return count; // Return the total number of books exported
 }
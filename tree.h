@@ -9,17 +9,31 @@
 #ifndef _TREE_H
 #define _TREE_H
 #include<string>
+#include<unordered_map>
+#include<ostream>
 #include "myvector.h"
+#include "pool.h"
 #include "book.h"
+#include "stringpool.h"
+#include "textarena.h"
+#include "flattree.h"
 using namespace std;
 class Node
 {
 	private:
-		string name;				//name of the Node
+		const string* name;			//interned name of the Node, "General" is stored once for every branch
 		MyVector<Node*> children;	//Children of Node
+		unordered_map<string, Node*> childIndex;	//Children of Node keyed by name
 		MyVector<Book*> books;		//Books in every Node
 		unsigned int bookCount;
 		Node* parent; 				//link to the parent 
+		uint32_t flatId;			//id of the node in the tree's flat layout, valid while the layout is current
+		string path;				//cached category path, "" for the root
+		uint32_t pathGeneration;	//bumped whenever path is rebuilt, the children's caches compare against it
+		uint32_t pathFor;			//parent's pathGeneration the cached path was built from, STALE to force a rebuild
+
+		static const uint32_t STALE = 0xffffffff;
+		const string& cachedPath();	//the category path, rebuilding the stale caches on the way up first
 
 	public:
 		//constructor to create an empty node (category/sub-category)
@@ -28,13 +42,17 @@ class Node
 		// return category of a node (e.g. "Computer Science/Operating Systems")
 		// where "Operator System" is the name of current node and "Operating System"
 		// is the name of the parent node which is a child of the root node.
+		// The path is cached in the node and only rebuilt after the node or one of its
+		// ancestors was renamed, with a single concatenation onto the parent's path.
 		string getCategory(Node* node);
 		
-		//deletes a node and clear/clean all its vectors
-		~Node();	
+		//the Tree frees the children and books of a node through its pools
+
+		static StringPool names;	//the names of every node, interned
 
 	public:
 		friend class Tree;
+		friend class FlatTree;
 		friend class LCMS;
 };
 //==========================================================
@@ -42,25 +60,47 @@ class Tree
 {
 	private:
 		Node *root;				//root of the Tree
+		unordered_map<string, Node*> pathCache;	//resolved paths (without leading '/') to their nodes
+		Pool<Node> nodePool;	//every node of the tree
+		Pool<Book> bookPool;	//every book of the tree
+		TextArena titleArena;	//the titles of the books of the tree
+		uint64_t generation;	//bumped by every change to the nodes or to the books of a node
+		FlatTree flat;			//pre-order copy of the structure, rebuilt when the generation moved
+		void destroy_helper(Node* node);	//return a subtree's nodes and books to the pools
+
+		static const uint32_t TASK_BOOKS = 2048;	//books formatted by one task of a parallel scan
+		static const int TASKS_PER_THREAD = 8;		//tasks per thread held in memory at once, so stealing has something to balance
+		typedef void (*Formatter)(const FlatTree& flat, uint32_t begin, uint32_t end, string& out);
+		static void formatBooks(const FlatTree& flat, uint32_t begin, uint32_t end, string& out);	//books as findAll prints them
+		static void formatRows(const FlatTree& flat, uint32_t begin, uint32_t end, string& out);	//books as CSV rows of an export
+		uint32_t writeSubtree(Node* node, int threads, Formatter format, ostream& out);	//format the books of a subtree in parallel, write them in order
 		
 	public:	 	//Required methods
 		Tree(string rootName);	
-		~Tree();
+		~Tree();				//frees every node and book at once by releasing the pools
 		Node* getRoot();
+		Pool<Node>& getNodePool();	//allocator of the nodes of the tree
+		Pool<Book>& getBookPool();	//allocator of the books of the tree, books added to a node must come from it
+		TextArena& getTitleArena();	//arena the titles of the tree's books are stored in
+		const FlatTree& layout();	//the flat layout of the current tree, rebuilt first if it is stale
 		void insert(Node* node,string name);			//insert a new child to a given node of of the tree
 		void remove(Node* node,string child_name);		//remove a specific child from a given node of the tree
+		void rename(Node* node,string new_name);		//rename a node, keeping its parent's child index in sync
 		bool isRoot(Node* node); 						//return true if the given node is the root, false otherwise
-		Node* getNode(string path);						//given a path (category/sub-category/sub-category/..) the method should return the Node if found, false otherwise
-		Node* createNode(string path);					//Create a node on a given path, e.g. category/sub-category/sub-category/...
+		Node* getNode(const string& path);				//given a path (category/sub-category/sub-category/..) the method should return the Node if found, false otherwise
+		Node* createNode(const string& path);				//Create a node on a given path, e.g. category/sub-category/sub-category/...
 		Node* getChild(Node *ptr, string childname);	//given a node and name of a child, the method returns pointer to the child node if exist, nullptr otherwise
 		void updateBookCount(Node *ptr, int offset);	//update a books count by an offset e.g. +1/-1
+		void recountBooks();							//recompute the bookCount of every node from the flat layout
+		void addBook(Node* node, Book* book);			//append a book of the book pool to a node and link it to the node, the caller updates the counts
 		Book* findBook(Node *node, string bookTitle);	//find a book in a given node, returns nullptr the book is not found
-		bool removeBook(Node* node,string bookTitle);   //remove a book from a given node
-		void printAll(Node *node);					    //printAll books of a node and it children recursively (see output of findAll command)
+		bool removeBook(Node* node,Book* book);   //remove and free a book of a given node
+		void printAll(Node *node, int threads = 1);	    //printAll books of a node and it children recursively (see output of findAll command)
 		bool isLastChild(Node *ptr);	//given a pointer to node, the method should determine that the node is the last child in the children vector or not
+		bool precedes(Node* a, Node* b);	//true if a comes before b in pre-order, found from their ancestors without a layout
 		void print();			//Print all categories/sub-categories of a the tree. see output of list command (please use the implementation given below)
 		void print_helper(string padding, string pointer,Node *node); // helper method for the print() (please use the implementation given below)
-		int exportData(Node *node,ofstream& file);		//Export all books of a given node to a specific file.
+		int exportData(Node *node,ofstream& file, int threads = 1);	//Export all books of a given node and its children to a specific file.
 		//bool isEmpty();									//return true if the tree is empty false otherwise
 };
 #endif